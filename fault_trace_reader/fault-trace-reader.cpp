@@ -0,0 +1,60 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../source/fault-trace-layout.h"
+
+//usage: fault-trace-reader <trace file>
+//prints, as csv, the fault events written by an ApproxSS run compiled with FAULT_EVENT_TRACE (pintool argument -fet)
+
+const std::string ErrorCategoryNames[] = {"Read", "Write", "Passive"};
+
+int main(const int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <trace file>" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const int fd = open(argv[1], O_RDONLY);
+	struct stat fileStatus;
+	if (fd < 0 || fstat(fd, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) < sizeof(FaultTraceLayout::Header)) {
+		std::cerr << "Unable to open fault trace file: \"" << argv[1] << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const size_t fileSize = static_cast<size_t>(fileStatus.st_size);
+	void* const mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		std::cerr << "Unable to map fault trace file: \"" << argv[1] << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const FaultTraceLayout::Header& header = *static_cast<const FaultTraceLayout::Header*>(mapping);
+
+	if (header.m_magic != FaultTraceLayout::MAGIC || header.m_version != FaultTraceLayout::VERSION || header.m_eventSize != sizeof(FaultTraceLayout::Event)) {
+		std::cerr << "Not a fault trace file of version " << FaultTraceLayout::VERSION << ": \"" << argv[1] << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	//an unfinished run leaves the event count at 0, so whatever was flushed is read
+	const uint64_t flushedEvents = (fileSize - sizeof(FaultTraceLayout::Header)) / sizeof(FaultTraceLayout::Event);
+	const uint64_t eventCount = (header.m_eventCount != 0 && header.m_eventCount < flushedEvents) ? header.m_eventCount : flushedEvents;
+	const FaultTraceLayout::Event* const events = reinterpret_cast<const FaultTraceLayout::Event*>(static_cast<const uint8_t*>(mapping) + sizeof(FaultTraceLayout::Header));
+
+	std::cerr << "Process " << header.m_processId << ": " << eventCount << " events, " << header.m_droppedEvents << " dropped." << std::endl;
+
+	std::cout << "Period,Buffer,Element,Bit,Category,Thread" << std::endl;
+	for (uint64_t i = 0; i < eventCount; ++i) {
+		const FaultTraceLayout::Event& event = events[i];
+		std::cout << event.m_period << ',' << event.m_bufferId << ',' << event.m_elementIndex << ',' << event.m_bit << ',' << ((event.m_category < 3) ? ErrorCategoryNames[event.m_category] : "?") << ',' << event.m_threadId << '\n';
+	}
+
+	munmap(mapping, fileSize);
+
+	return EXIT_SUCCESS;
+}
@@ -18,6 +18,16 @@ int __attribute__((optimize("O0"))) ApproxSS::remove_approx(void * const start_a
 	return 0;
 }
 
+int __attribute__((optimize("O0"))) ApproxSS::add_approx_batch(approx_descriptor const * const descriptors, const uint64_t count, int a/* = 0*/, int b/* = 0*/, int c/* = 0*/, int d/* = 0*/, int e/* = 0*/, int f/* = 0*/, int g/* = 0*/) //9 parameters
+{
+	return 0;
+}
+
+int __attribute__((optimize("O0"))) ApproxSS::remove_approx_batch(approx_descriptor const * const descriptors, const uint64_t count, const bool giveAwayRecords/*= true*/, int a/* = 0*/, int b/* = 0*/, int c/* = 0*/, int d/* = 0*/, int e/* = 0*/, int f/* = 0*/, int g/* = 0*/) //10 parameters
+{
+	return 0;
+}
+
 int __attribute__((optimize("O0"))) ApproxSS::next_period(int a/*= 0*/, int b/*= 0*/)	// 2 parameters
 {
 	return 0;
@@ -2,11 +2,21 @@
 #define APPROX_INSTRUMENTATION_H
 
 //parameters named with a single letter are not actually used, they just serve to avoid a Pin bug.
+//ApproxSS finds these functions by their undecorated names (ApproxSS::<name>, see TargetInstrumentation::FindMarkers), or by their plain names if declared extern "C". their parameter counts must not be changed.
 
 #include <cstdint>
 
 namespace ApproxSS {
 
+	//one approximate buffer of a batch, with the parameters of add_approx
+	struct approx_descriptor {
+		void * start_address;
+		void const * end_address;
+		int64_t bufferId;
+		int64_t configurationId;
+		uint32_t dataSizeInBytes;
+	};
+
 	int __attribute__((optimize("O0"))) start_level(int level = 0); //1 parameters
 
 	int __attribute__((optimize("O0"))) end_level(); //0 parameters
@@ -15,6 +25,10 @@ namespace ApproxSS {
 
 	int __attribute__((optimize("O0"))) remove_approx(void * const start_address, void const * const end_address, const bool giveAwayRecords = true); //3 parameters
 
+	int __attribute__((optimize("O0"))) add_approx_batch(approx_descriptor const * const descriptors, const uint64_t count, int a = 0, int b = 0, int c = 0, int d = 0, int e = 0, int f = 0, int g = 0); //9 parameters
+
+	int __attribute__((optimize("O0"))) remove_approx_batch(approx_descriptor const * const descriptors, const uint64_t count, const bool giveAwayRecords = true, int a = 0, int b = 0, int c = 0, int d = 0, int e = 0, int f = 0, int g = 0); //10 parameters
+
 	int __attribute__((optimize("O0"))) next_period(int a = 0, int b = 0); // 2 parameters
 
 	int __attribute__((optimize("O0"))) enable_global_injection(int a = 0, int b = 0, int c = 0, int d = 0); //4 parameters
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "../source/live-statistics-layout.h"
+
+//usage: live-statistics-reader <segment name> [poll interval in ms]
+//prints the statistics published by an ApproxSS run compiled with LIVE_STATISTICS (pintool argument -lsn)
+
+const std::string ErrorCategoryNames[LiveStatisticsLayout::ERROR_CATEGORIES] = {"Read", "Write", "Passive"};
+const std::string ProfiledSectionNames[LiveStatisticsLayout::PROFILED_SECTIONS] = {"CheckAndForward", "BufferLookup", "InjectFault", "BackupReadData", "ReverseFaultyRead", "ApplyFaultyWrite", "PassiveCatchUp", "NextPeriod"};
+
+uint64_t sumAccessedBytes(const LiveStatisticsLayout::Snapshot& snapshot, const size_t precision) {
+	uint64_t total = 0;
+	for (size_t j = 0; j < LiveStatisticsLayout::ACCESS_TYPES; ++j) {
+		total += snapshot.m_accessedBytes[precision][j];
+	}
+	return total;
+}
+
+void printSnapshot(const LiveStatisticsLayout::Snapshot& snapshot, const LiveStatisticsLayout::Snapshot& previous) {
+	const double seconds = snapshot.m_elapsedNanoseconds / 1e9;
+	const double deltaSeconds = (snapshot.m_elapsedNanoseconds - previous.m_elapsedNanoseconds) / 1e9;
+
+	const uint64_t approximateBytes = sumAccessedBytes(snapshot, 1);
+	const uint64_t deltaBytes = (sumAccessedBytes(snapshot, 0) + approximateBytes) - (sumAccessedBytes(previous, 0) + sumAccessedBytes(previous, 1));
+
+	std::cout << "[" << seconds << " s] Period: " << snapshot.m_currentPeriod << " | Active buffers: " << snapshot.m_activeBuffers << " | Injection calls: " << snapshot.m_injectionCalls << std::endl;
+	std::cout << "\tAccessed bytes (precise/approximate): " << sumAccessedBytes(snapshot, 0) << " / " << approximateBytes;
+	if (deltaSeconds > 0) {
+		std::cout << " | Throughput: " << (deltaBytes / deltaSeconds / 1e6) << " MB/s";
+	}
+	std::cout << std::endl;
+
+	std::cout << "\tErrors (closed periods):";
+	for (size_t i = 0; i < LiveStatisticsLayout::ERROR_CATEGORIES; ++i) {
+		std::cout << " " << ErrorCategoryNames[i] << ": " << snapshot.m_injectedErrors[i];
+	}
+	std::cout << std::endl;
+
+	for (size_t i = 0; i < LiveStatisticsLayout::PROFILED_SECTIONS; ++i) {
+		if (snapshot.m_profiledCalls[i] != 0) {
+			std::cout << "\t" << ProfiledSectionNames[i] << ": " << snapshot.m_profiledCalls[i] << " calls, " << (snapshot.m_profiledCycles[i] / snapshot.m_profiledCalls[i]) << " cycles/call" << std::endl;
+		}
+	}
+}
+
+int main(const int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <segment name> [poll interval in ms]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string path = std::string("/dev/shm/") + argv[1];
+	const unsigned interval = (argc > 2) ? static_cast<unsigned>(std::stoul(argv[2])) : 1000;
+
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "Unable to open live statistics segment: \"" << path << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	void* const mapping = mmap(nullptr, sizeof(LiveStatisticsLayout::Region), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		std::cerr << "Unable to map live statistics segment: \"" << path << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const LiveStatisticsLayout::Region& region = *static_cast<const LiveStatisticsLayout::Region*>(mapping);
+
+	while (region.m_magic != LiveStatisticsLayout::MAGIC) {
+		usleep(interval * 1000);
+	}
+
+	if (region.m_version != LiveStatisticsLayout::VERSION) {
+		std::cerr << "Live statistics version mismatch: segment " << region.m_version << ", reader " << LiveStatisticsLayout::VERSION << "." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "Reading live statistics of process " << region.m_processId << " at \"" << path << "\"." << std::endl;
+
+	LiveStatisticsLayout::Snapshot previous{};
+	LiveStatisticsLayout::Snapshot snapshot{};
+
+	while (true) {
+		if (LiveStatisticsLayout::ReadSnapshot(region, snapshot) && snapshot.m_publications != previous.m_publications) {
+			printSnapshot(snapshot, previous);
+			previous = snapshot;
+
+			if (snapshot.m_isFinished) {
+				break;
+			}
+		}
+
+		usleep(interval * 1000);
+	}
+
+	munmap(mapping, sizeof(LiveStatisticsLayout::Region));
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,300 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <map>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../source/persistent-counters-layout.h"
+
+//usage: persistent-counters-reader <counters file> [access log]
+//renders the access log of an ApproxSS run compiled with PERSISTENT_COUNTERS (pintool argument -pcf), even if the target crashed before Fini
+//the text follows PintoolOutput::WriteAccessLog, ApproximateBuffer::WriteAccessLogToFile and PeriodLog::WriteAccessLogToFile
+
+using namespace PersistentCountersLayout;
+
+constexpr size_t BYTE_SIZE = 8;
+
+const std::string ErrorCategoryNames[ERROR_CATEGORIES] = {"Read", "Write", "Passive"};
+const std::string AccessPrecisionNames[ACCESS_PRECISIONS] = {"Precise", "Approximate"};
+const std::string AccessTypesNames[ACCESS_TYPES] = {"Read", "Write"};
+
+typedef std::tuple<uint64_t, uint64_t, int64_t, int64_t, uint64_t> BufferKey; //same order as the pintool's GeneralBufferRecord
+
+class Buffer {
+	public:
+		BufferRecord const * m_record;
+		std::map<uint64_t, PeriodRecord const *> m_periods; //by period, a later record of the same period supersedes the earlier ones
+};
+
+void writeAccessedBytes(std::ostream& outputLog, const uint64_t bitDepth, const uint64_t dataSizeInBytes, const uint64_t accessedBytes, const std::string& accessedType, const std::string& accessScope, const std::string& padding) {
+	outputLog << padding << accessScope << " " << accessedType << " Software Implementation Bytes/Bits: " << accessedBytes << " / " << (accessedBytes * BYTE_SIZE) << std::endl;
+	outputLog << padding << accessScope << " " << accessedType << " Proposed Implementation Bytes/Bits: " << (((accessedBytes / dataSizeInBytes) * bitDepth) / BYTE_SIZE) << " / " << ((accessedBytes / dataSizeInBytes) * bitDepth) << std::endl;
+}
+
+void writeExtrapolatedInjections(std::ostream& outputLog, const std::string& errorType, const uint64_t sampledInjections, const uint64_t approximateBytes, const uint64_t sampledApproximateBytes) {
+	outputLog << "Extrapolated " << errorType << " Errors: ";
+
+	if (sampledApproximateBytes == 0) {
+		outputLog << ((approximateBytes == 0) ? "0" : "NaN") << std::endl;
+		return;
+	}
+
+	const double scale = static_cast<double>(approximateBytes) / static_cast<double>(sampledApproximateBytes);
+	const double estimate = static_cast<double>(sampledInjections) * scale;
+
+	if (sampledInjections == 0) {
+		outputLog << "0 (95% upper bound: " << (3.0 * scale) << ")" << std::endl;
+	} else {
+		const double margin = 1.96 * std::sqrt(static_cast<double>(sampledInjections)) * scale;
+		outputLog << estimate << " +- " << margin << " (95% confidence)" << std::endl;
+	}
+}
+
+void writePeriod(std::ostream& outputLog, const Header& header, const BufferRecord& buffer, const PeriodRecord& period, uint64_t (&bufferAccessedBytes)[ACCESS_PRECISIONS][ACCESS_TYPES], uint64_t (&totalInjections)[ERROR_CATEGORIES], uint64_t (&totalSampledBytes)[ACCESS_TYPES], const size_t errorCategories) {
+	const std::string basePadding = "\t";
+	const std::string padding = "\t\t";
+
+	outputLog << basePadding << "PERIOD START" << std::endl;
+	if ((header.m_flags & FLAG_PERIOD_COUNT) && period.m_periodCount > 1) {
+		outputLog << padding << "For the periods: " << period.m_period << " to " << (period.m_period + period.m_periodCount - 1) << " (idle)" << std::endl;
+	} else {
+		outputLog << padding << "For the period: " << period.m_period << std::endl;
+	}
+
+	if (header.m_flags & FLAG_PERIOD_SAMPLING) {
+		outputLog << padding << "Sampled: " << (period.m_isSampled ? "Yes" : "No") << std::endl;
+	}
+
+	for (size_t i = 0; i < ACCESS_PRECISIONS; ++i) {
+		for (size_t j = 0; j < ACCESS_TYPES; ++j) {
+			writeAccessedBytes(outputLog, buffer.m_bitDepth, buffer.m_dataSizeInBytes, period.m_accessedBytes[i][j], AccessTypesNames[j], "Period " + AccessPrecisionNames[i], padding);
+			bufferAccessedBytes[i][j] += period.m_accessedBytes[i][j];
+		}
+	}
+	outputLog << std::endl;
+
+	if ((header.m_flags & FLAG_PERIOD_SAMPLING) && period.m_isSampled) {
+		for (size_t j = 0; j < ACCESS_TYPES; ++j) {
+			totalSampledBytes[j] += period.m_accessedBytes[1][j];
+		}
+	}
+
+	for (size_t i = 0; i < errorCategories; ++i) {
+		outputLog << padding << ErrorCategoryNames[i] << " sub-BER index: " << period.m_berIndex[i] << std::endl;
+	}
+
+	if (header.m_flags & FLAG_LOG_FAULTS) {
+		outputLog << std::endl;
+		outputLog << padding << "INJECTION COUNT START" << std::endl;
+		for (size_t i = 0; i < errorCategories; ++i) {
+			uint64_t const * const injectedByBit = GetErrorCountsByBit(&period, i);
+
+			outputLog << padding << '\t' << ErrorCategoryNames[i] << " errors injected by bit:" << std::endl;
+
+			uint64_t periodTotalInjected = 0;
+			for (size_t b = 0; b < period.m_bitDepth; ++b) {
+				outputLog << padding << "\t\tBit " << b << ": " << injectedByBit[b] << std::endl;
+				periodTotalInjected += injectedByBit[b];
+			}
+
+			outputLog << padding << '\t' << "Period " << ErrorCategoryNames[i] << " injected errors: " << periodTotalInjected << std::endl;
+			totalInjections[i] += periodTotalInjected;
+
+			outputLog << std::endl;
+		}
+		outputLog << padding << "INJECTION COUNT END" << std::endl;
+	}
+
+	outputLog << basePadding << "PERIOD END" << std::endl;
+	outputLog << std::endl;
+}
+
+void writeBuffer(std::ostream& outputLog, const Header& header, const Buffer& buffer, uint64_t (&totalAccessedBytes)[ACCESS_PRECISIONS][ACCESS_TYPES], uint64_t (&totalInjections)[ERROR_CATEGORIES], uint64_t (&totalSampledBytes)[ACCESS_TYPES], const size_t errorCategories) {
+	const BufferRecord& record = *buffer.m_record;
+	const std::string padding = "\t";
+
+	const uint64_t softwareSizeInBytes = record.m_finalAddress - record.m_initialAddress;
+	const uint64_t elementCount = softwareSizeInBytes / record.m_dataSizeInBytes;
+	const uint64_t implementationSizeInBits = elementCount * record.m_bitDepth;
+
+	outputLog << std::endl;
+	outputLog << "BUFFER START" << std::endl;
+	outputLog << padding << "Buffer Id: " << record.m_bufferId << std::endl;
+	outputLog << padding << "Initial Address: " << record.m_initialAddress << std::endl;
+	outputLog << padding << "Final Address: " << record.m_finalAddress << std::endl;
+	outputLog << padding << "Configuration Id: " << record.m_configurationId << std::endl;
+	outputLog << padding << "Data Size (Bytes): " << record.m_dataSizeInBytes << std::endl;
+	outputLog << padding << "Bit Depth: " << record.m_bitDepth << std::endl;
+	outputLog << padding << "Buffer Software Implementation Size Bytes/Bits: " << softwareSizeInBytes << " / " << (softwareSizeInBytes * BYTE_SIZE) << std::endl;
+	outputLog << padding << "Buffer Proposed Implementation Size Bytes/Bits: " << (implementationSizeInBits / BYTE_SIZE) << " / " << implementationSizeInBits << std::endl;
+	outputLog << padding << "Buffer Elements: " << elementCount << std::endl << std::endl;
+
+	uint64_t bufferAccessedBytes[ACCESS_PRECISIONS][ACCESS_TYPES] = {};
+	for (const auto& [_, period] : buffer.m_periods) {
+		writePeriod(outputLog, header, record, *period, bufferAccessedBytes, totalInjections, totalSampledBytes, errorCategories);
+	}
+
+	outputLog << padding << "BUFFER TOTALS" << std::endl;
+
+	for (size_t i = 0; i < ACCESS_PRECISIONS; ++i) {
+		for (size_t j = 0; j < ACCESS_TYPES; ++j) {
+			writeAccessedBytes(outputLog, record.m_bitDepth, record.m_dataSizeInBytes, bufferAccessedBytes[i][j], AccessTypesNames[j], "Buffer " + AccessPrecisionNames[i], padding);
+			totalAccessedBytes[i][j] += bufferAccessedBytes[i][j];
+		}
+	}
+
+	outputLog << padding << "Buffer Active Periods: " << buffer.m_periods.size() << std::endl;
+
+	outputLog << "BUFFER END" << std::endl;
+}
+
+int main(const int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " <counters file> [access log]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const int fd = open(argv[1], O_RDONLY);
+	if (fd < 0) {
+		std::cerr << "Unable to open persistent counters file: \"" << argv[1] << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	struct stat fileStatus;
+	if (fstat(fd, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) < sizeof(Header)) {
+		close(fd);
+		std::cerr << "Not a persistent counters file: \"" << argv[1] << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const size_t fileSize = static_cast<size_t>(fileStatus.st_size);
+	void* const mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mapping == MAP_FAILED) {
+		std::cerr << "Unable to map persistent counters file: \"" << argv[1] << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	uint8_t const * const base = static_cast<uint8_t const *>(mapping);
+	const Header& header = *reinterpret_cast<Header const *>(base);
+
+	if (header.m_magic != MAGIC) {
+		std::cerr << "Not a persistent counters file: \"" << argv[1] << "\"." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (header.m_version != VERSION) {
+		std::cerr << "Persistent counters version mismatch: file " << header.m_version << ", reader " << VERSION << "." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!header.m_isComplete) {
+		std::cerr << "Note: process " << header.m_processId << " did not reach the end of its execution, the periods in progress are reported as they were." << std::endl;
+	}
+	if (header.m_droppedRecords != 0) {
+		std::cerr << "Warning: " << header.m_droppedRecords << " records did not fit in the file, their buffers or periods are missing." << std::endl;
+	}
+	if (header.m_flags & FLAG_EXPECTED_ERRORS) {
+		std::cerr << "Warning: the run reported expected errors (ANALYTIC_ERROR_EXPECTATION), the injected ones are reported instead." << std::endl;
+	}
+
+	const size_t errorCategories = (header.m_flags & FLAG_PASSIVE_INJECTION) ? ERROR_CATEGORIES : (ERROR_CATEGORIES - 1);
+	const uint64_t usedBytes = std::min<uint64_t>(header.m_usedBytes, fileSize);
+
+	std::map<uint64_t, Buffer> buffersByOffset;
+	uint64_t orphanPeriods = 0;
+
+	for (uint64_t offset = sizeof(Header); offset + sizeof(RecordHeader) <= usedBytes; ) {
+		const RecordHeader& record = *reinterpret_cast<RecordHeader const *>(base + offset);
+
+		if (record.m_size < sizeof(RecordHeader) || offset + record.m_size > usedBytes) {
+			std::cerr << "Warning: malformed record at offset " << offset << ", the rest of the file is ignored." << std::endl;
+			break;
+		}
+
+		if (record.m_type == BUFFER_RECORD) {
+			buffersByOffset[offset].m_record = reinterpret_cast<BufferRecord const *>(&record);
+		} else if (record.m_type == PERIOD_RECORD) {
+			PeriodRecord const * const period = reinterpret_cast<PeriodRecord const *>(&record);
+			const std::map<uint64_t, Buffer>::iterator it = buffersByOffset.find(period->m_bufferRecord);
+
+			if (it == buffersByOffset.end()) {
+				++orphanPeriods;
+			} else if (!period->m_isDiscarded) {
+				it->second.m_periods[period->m_period] = period;
+			}
+		}
+
+		offset += record.m_size;
+	}
+
+	if (orphanPeriods != 0) {
+		std::cerr << "Warning: " << orphanPeriods << " period records belong to buffers that did not fit in the file." << std::endl;
+	}
+
+	std::map<BufferKey, Buffer const *> buffers;
+	for (const auto& [_, buffer] : buffersByOffset) {
+		const BufferRecord& record = *buffer.m_record;
+		buffers.emplace(BufferKey(record.m_initialAddress, record.m_finalAddress, record.m_bufferId, record.m_configurationId, record.m_dataSizeInBytes), &buffer);
+	}
+
+	std::ofstream outputFile;
+	if (argc > 2) {
+		outputFile.open(argv[2], std::ofstream::trunc);
+		if (!outputFile) {
+			std::cerr << "Unable to create output file: \"" << argv[2] << "\"." << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	std::ostream& outputLog = (argc > 2) ? outputFile : std::cout;
+
+	outputLog << "Total Injection Calls: " << header.m_injectionCalls << std::endl;
+
+	uint64_t totalAccessedBytes[ACCESS_PRECISIONS][ACCESS_TYPES] = {};
+	uint64_t totalInjections[ERROR_CATEGORIES] = {};
+	uint64_t totalSampledBytes[ACCESS_TYPES] = {};
+
+	for (const auto& [_, buffer] : buffers) {
+		writeBuffer(outputLog, header, *buffer, totalAccessedBytes, totalInjections, totalSampledBytes, errorCategories);
+	}
+
+	uint64_t totalAccesses = 0;
+	outputLog << std::endl;
+	for (size_t i = 0; i < ACCESS_PRECISIONS; ++i) {
+		for (size_t j = 0; j < ACCESS_TYPES; ++j) {
+			outputLog << "Total Software Implementation " << AccessPrecisionNames[i] << " " << AccessTypesNames[j] << " Bytes/Bits: " << totalAccessedBytes[i][j] << " / " << (totalAccessedBytes[i][j] * BYTE_SIZE) << std::endl;
+			totalAccesses += totalAccessedBytes[i][j];
+		}
+	}
+	outputLog << "Total Software Implementation Accessed Bytes/Bits: " << totalAccesses << " / " << (totalAccesses * BYTE_SIZE) << std::endl;
+
+	if (header.m_flags & FLAG_LOG_FAULTS) {
+		uint64_t injections = 0;
+		outputLog << std::endl;
+
+		for (size_t i = 0; i < errorCategories; ++i) {
+			outputLog << "Total " << ErrorCategoryNames[i] << " Errors Injected: " << totalInjections[i] << std::endl;
+			injections += totalInjections[i];
+		}
+
+		outputLog << "Total Errors Injected: " << injections << std::endl;
+
+		if (header.m_flags & FLAG_PERIOD_SAMPLING) {
+			outputLog << std::endl;
+			for (size_t i = 0; i < ACCESS_TYPES; ++i) {
+				writeExtrapolatedInjections(outputLog, ErrorCategoryNames[i], totalInjections[i], totalAccessedBytes[1][i], totalSampledBytes[i]);
+			}
+		}
+	}
+
+	munmap(mapping, fileSize);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+#include "access-heatmap.h"
+
+#if ACCESS_HEATMAP
+	#include <iostream>
+
+	namespace AccessHeatmap {
+		size_t g_blockShift = 12;
+		uint64_t g_samplingInterval = 1;
+
+		PerThreadSlots<ThreadContext> g_threadContexts{};
+
+		void Configure(const uint64_t blockSizeInBytes, const uint64_t samplingInterval) {
+			if (blockSizeInBytes == 0 || (blockSizeInBytes & (blockSizeInBytes - 1)) != 0) {
+				std::cerr << "ApproxSS Error: the heatmap block size (" << blockSizeInBytes << ") must be a power of two." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			if (samplingInterval == 0) {
+				std::cerr << "ApproxSS Error: the heatmap sampling interval must be greater than 0." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			AccessHeatmap::g_blockShift = static_cast<size_t>(__builtin_ctzll(blockSizeInBytes));
+			AccessHeatmap::g_samplingInterval = samplingInterval;
+		}
+
+		BufferHeatmap::BufferHeatmap(const size_t bufferSizeInBytes) :
+			m_blocks(),
+			m_blockCount(std::max<size_t>((bufferSizeInBytes + (static_cast<size_t>(1) << g_blockShift) - 1) >> g_blockShift, 1)),
+			m_samplingCountdown(g_samplingInterval)
+		{
+			this->m_blocks = std::unique_ptr<Block[]>(new Block[this->m_blockCount]());
+		}
+
+		void WriteHeaderToFile(std::ofstream& outputLog) {
+			outputLog << "#block size: " << (static_cast<uint64_t>(1) << g_blockShift) << " bytes, sampling interval: " << g_samplingInterval << std::endl;
+			outputLog << "buffer,block,offset,read bytes,written bytes,injected faults" << std::endl;
+		}
+
+		void BufferHeatmap::WriteToFile(std::ofstream& outputLog, const int64_t bufferId) const {
+			for (size_t i = 0; i < this->m_blockCount; ++i) {
+				const Block& block = this->m_blocks[i];
+				outputLog << bufferId << ',' << i << ',' << (i << g_blockShift) << ',' << block.m_accessedBytes[AccessTypes::Read] << ',' << block.m_accessedBytes[AccessTypes::Write] << ',' << block.m_injectedFaults << '\n';
+			}
+		}
+	}
+#endif
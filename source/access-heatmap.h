@@ -0,0 +1,105 @@
+#ifndef ACCESS_HEATMAP_H
+#define ACCESS_HEATMAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include "pin.H"
+
+#include "compiling-options.h"
+#include "per-thread-slots.h"
+
+#if ACCESS_HEATMAP
+	//bytes accessed and faults injected over fixed-size blocks of each approximate buffer
+	//accesses are sampled (every k-th access of the buffer, scaled by k), faults are all counted
+	namespace AccessHeatmap {
+		extern size_t g_blockShift;			//log2 of the block size in bytes
+		extern uint64_t g_samplingInterval;	//k
+
+		void Configure(const uint64_t blockSizeInBytes, const uint64_t samplingInterval);
+
+		class Block {
+			public:
+				std::array<uint64_t, AccessTypes::Size> m_accessedBytes;	//estimated (scaled by the sampling interval)
+				uint64_t m_injectedFaults;
+		};
+
+		class BufferHeatmap {
+			private:
+				std::unique_ptr<Block[]> m_blocks;
+				const size_t m_blockCount;
+				uint64_t m_samplingCountdown;
+
+				size_t GetBlock(const size_t offset) const {
+					return std::min(offset >> g_blockShift, this->m_blockCount - 1);
+				}
+
+			public:
+				BufferHeatmap(const size_t bufferSizeInBytes);
+
+				//MUST LOCK
+				//offset from the beginning of the buffer, a sampled access is split over the blocks it spans
+				void RecordAccess(const size_t offset, const size_t type, const size_t size) {
+					if (--this->m_samplingCountdown != 0) {
+						return;
+					}
+					this->m_samplingCountdown = g_samplingInterval;
+
+					const size_t firstBlock = this->GetBlock(offset);
+					const size_t lastBlock = this->GetBlock(offset + size - 1);
+
+					if (firstBlock == lastBlock) {
+						this->m_blocks[firstBlock].m_accessedBytes[type] += size * g_samplingInterval;
+						return;
+					}
+
+					for (size_t block = firstBlock; block <= lastBlock; ++block) {
+						const size_t blockBegin = std::max(offset, block << g_blockShift);
+						const size_t blockEnd = (block == lastBlock) ? (offset + size) : ((block + 1) << g_blockShift);
+						this->m_blocks[block].m_accessedBytes[type] += (blockEnd - blockBegin) * g_samplingInterval;
+					}
+				}
+
+				void RecordFault(const size_t offset) {
+					++this->m_blocks[this->GetBlock(offset)].m_injectedFaults;
+				}
+
+				void WriteToFile(std::ofstream& outputLog, const int64_t bufferId) const;
+		};
+
+		//the heatmap of the buffer currently injecting faults in each thread, set right before it calls the fault injector
+		class alignas(64) ThreadContext {
+			public:
+				BufferHeatmap* m_heatmap;
+				uint8_t const * m_bufferBegin;
+		};
+
+		extern PerThreadSlots<ThreadContext> g_threadContexts;
+
+		inline ThreadContext& GetThreadContext() {
+			return g_threadContexts.Get();
+		}
+
+		inline void SetContext(BufferHeatmap * const heatmap, uint8_t const * const bufferBegin) {
+			ThreadContext& context = AccessHeatmap::GetThreadContext();
+			context.m_heatmap = heatmap;
+			context.m_bufferBegin = bufferBegin;
+		}
+
+		inline void RecordFault(uint8_t const * const data) {
+			const ThreadContext& context = AccessHeatmap::GetThreadContext();
+			context.m_heatmap->RecordFault(static_cast<size_t>(data - context.m_bufferBegin));
+		}
+
+		void WriteHeaderToFile(std::ofstream& outputLog);
+	}
+
+	#define HEATMAP_FAULT(data) AccessHeatmap::RecordFault(data);
+#else
+	#define HEATMAP_FAULT(data)
+#endif
+
+#endif /* ACCESS_HEATMAP_H */
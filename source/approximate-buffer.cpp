@@ -1,4 +1,5 @@
 #include "approximate-buffer.h"
+#include "live-statistics.h"
 
 namespace BorrowedMemory {
 	//#if LONG_TERM_BUFFER
@@ -20,9 +21,13 @@ ApproximateBuffer::ApproximateBuffer(const Range& bufferRange, const int64_t id,
 	Range(bufferRange),
 	m_id(id),
 	m_dataSizeInBytes(dataSizeInBytes),	
+	m_dataSizeShift((dataSizeInBytes != 0 && (dataSizeInBytes & (dataSizeInBytes - 1)) == 0) ? static_cast<size_t>(__builtin_ctzll(dataSizeInBytes)) : NO_DATA_SIZE_SHIFT),
 	m_minimumReadBackupSize(static_cast<size_t>(std::ceil(static_cast<double>(injectorCfg.GetBitDepth()) / static_cast<double>(BYTE_SIZE)))),
 	m_creationPeriod(creationPeriod),
 	m_isActive(1),
+	#if PERSISTENT_COUNTERS
+		m_persistentRecord(PersistentCounters::AddBuffer(id, injectorCfg.GetConfigurationId(), bufferRange.m_initialAddress, bufferRange.m_finalAddress, dataSizeInBytes, injectorCfg.GetBitDepth())),
+	#endif
 
 	#if DISTANCE_BASED_FAULT_INJECTOR
 		m_faultInjector(injectorCfg, dataSizeInBytes),
@@ -30,8 +35,20 @@ ApproximateBuffer::ApproximateBuffer(const Range& bufferRange, const int64_t id,
 		m_faultInjector(injectorCfg),
 	#endif
 
-	m_periodLog(creationPeriod, m_faultInjector),
+	m_periodLog(creationPeriod, m_faultInjector IF_COMMA_PERSISTENT_COUNTERS(m_persistentRecord)),
 	m_bufferLogs()
+	#if THREAD_PRIVATE_ACCESS_COUNTING
+		, m_threadAccessCounts()
+	#endif
+	#if PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS
+		, m_visibilitySlot(NO_VISIBILITY_SLOT)
+	#endif
+	#if SHADOW_MEMORY_LOOKUP
+		, m_shadowSlot(ShadowMemory::SHARED_PAGE)
+	#endif
+	#if ACCESS_HEATMAP
+		, m_heatmap(bufferRange.size())
+	#endif
 {
 
 	if (this->m_faultInjector.GetBitDepth() > (this->m_dataSizeInBytes * BYTE_SIZE)) {
@@ -122,6 +139,10 @@ void ApproximateBuffer::ReactivateBuffer(const uint64_t creationPeriod) {
 
 	const BufferLogs::const_iterator it = this->m_bufferLogs.find(creationPeriod);
 	if (it != this->m_bufferLogs.cend()) {
+		#if LIVE_STATISTICS && LOG_FAULTS
+			this->AddPeriodErrorsToLiveStatistics(*it->second, -1.0); //m_periodLog still holds these errors and will store them again
+		#endif
+
 		this->m_bufferLogs.erase(it);
 	} else {
 		this->m_periodLog.ResetCounts(creationPeriod, this->m_faultInjector);
@@ -130,22 +151,131 @@ void ApproximateBuffer::ReactivateBuffer(const uint64_t creationPeriod) {
 
 //MUST LOCK
 void ApproximateBuffer::StoreCurrentPeriodLog() {
+	#if THREAD_PRIVATE_ACCESS_COUNTING
+		for (const auto& [_, threadCounts] : this->m_threadAccessCounts) {
+			this->m_periodLog.MergeThreadAccessCounts(*threadCounts);
+		}
+	#endif
+
+	#if LIVE_STATISTICS && LOG_FAULTS
+		this->AddPeriodErrorsToLiveStatistics(this->m_periodLog, 1.0);
+	#endif
+
 	this->m_bufferLogs.emplace(this->m_periodLog.m_period, std::make_unique<PeriodLog>(this->m_periodLog, this->m_faultInjector.GetBitDepth()));
 }
 
+#if THREAD_PRIVATE_ACCESS_COUNTING
+	//MUST LOCK
+	//only called when a thread first accesses the buffer in one of its activations (the pintool keeps the result by visibility slot in the thread's control)
+	ThreadAccessCounts& ApproximateBuffer::GetThreadAccessCounts(const THREADID threadId) {
+		for (const auto& [countsThreadId, threadCounts] : this->m_threadAccessCounts) {
+			if (countsThreadId == threadId) {
+				return *threadCounts;
+			}
+		}
+
+		this->m_threadAccessCounts.emplace_back(threadId, std::make_unique<ThreadAccessCounts>(this->m_faultInjector.GetBitDepth()));
+		return *this->m_threadAccessCounts.back().second;
+	}
+#endif
+
+#if LIVE_STATISTICS && LOG_FAULTS
+	//MUST LOCK
+	void ApproximateBuffer::AddPeriodErrorsToLiveStatistics(const PeriodLog& periodLog, const double sign) const {
+		const size_t bitDepth = this->m_faultInjector.GetBitDepth();
+
+		for (size_t i = 0; i < ErrorCategory::Size; ++i) {
+			#if ANALYTIC_ERROR_EXPECTATION
+				const std::unique_ptr<ErrorCount[]> expectedByBit = periodLog.CalculateExpectedErrorsByBit(this->m_faultInjector, i, this->m_dataSizeInBytes, this->GetNumberOfElements());
+				ErrorCount const * const errorsByBit = expectedByBit.get();
+			#else
+				ErrorCount const * const errorsByBit = periodLog.GetErrorCountsByBit(i);
+			#endif
+
+			double periodErrors = 0;
+			for (size_t b = 0; b < bitDepth; ++b) {
+				periodErrors += errorsByBit[b];
+			}
+
+			LiveStatistics::g_injectedErrors[i] += sign * periodErrors;
+		}
+	}
+#endif
+
+#if LAZY_PERIOD_ADVANCEMENT
+	//MUST LOCK
+	//periods in [firstPeriod, endPeriod) in which the buffer was active but never accessed, stored as a single log unless their BERs differ
+	void ApproximateBuffer::StoreIdlePeriodLogs(const uint64_t firstPeriod, const uint64_t endPeriod) {
+		#if MULTIPLE_BER_CONFIGURATION
+			for (uint64_t period = firstPeriod; period < endPeriod; ++period) {
+				this->StoreIdlePeriodLog(period, 1);
+			}
+		#else
+			this->StoreIdlePeriodLog(firstPeriod, endPeriod - firstPeriod);
+		#endif
+	}
+
+	//MUST LOCK
+	void ApproximateBuffer::StoreIdlePeriodLog(const uint64_t period, const uint64_t periodCount) {
+		std::unique_ptr<PeriodLog> idleLog = std::make_unique<PeriodLog>(period, this->m_faultInjector IF_COMMA_PERSISTENT_COUNTERS(this->m_persistentRecord));
+		idleLog->m_periodCount = periodCount;
+
+		#if MULTIPLE_BER_CONFIGURATION
+			for (size_t i = 0; i < ErrorCategory::Size; ++i) {
+				idleLog->m_berIndex[i] = this->m_faultInjector.GetBerIndexFromPeriod(period) % this->m_faultInjector.GetBerCount(i);
+			}
+		#endif
+
+		#if PERIOD_SAMPLING
+			idleLog->m_isSampled = false; //nothing was accessed, so there was nothing to sample
+		#endif
+
+		#if PERSISTENT_COUNTERS
+			idleLog->UpdateRecord();
+		#endif
+
+		#if ENABLE_PASSIVE_INJECTION && DISTANCE_BASED_FAULT_INJECTOR
+			if (this->m_faultInjector.GetShouldGoOn(ErrorCategory::Passive)) {
+				for (uint64_t i = 0; i < periodCount; ++i) {
+					IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Passive, period + i);)
+					this->m_faultInjector.InjectFault(this->m_initialAddress, ErrorCategory::Passive, this->GetSoftwareBufferSSizeInBytes(), nullptr AND_LOG_ARGUMENT(idleLog->GetErrorCountsByBit(ErrorCategory::Passive)));
+				}
+			}
+		#endif
+
+		#if LIVE_STATISTICS && LOG_FAULTS
+			this->AddPeriodErrorsToLiveStatistics(*idleLog, 1.0);
+		#endif
+
+		this->m_bufferLogs.emplace(period, std::move(idleLog));
+	}
+#endif
+
 //WAS LOCKED
+//with LAZY_PERIOD_ADVANCEMENT, period may be several periods past the current log, the ones in between are stored as idle
 void ApproximateBuffer::NextPeriod(const uint64_t period) {
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
 	#if ENABLE_PASSIVE_INJECTION && DISTANCE_BASED_FAULT_INJECTOR 
 		if (this->m_faultInjector.GetShouldGoOn(ErrorCategory::Passive)) {
+			IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Passive, this->m_periodLog.m_period);)
 			this->m_faultInjector.InjectFault(this->m_initialAddress, ErrorCategory::Passive, this->GetSoftwareBufferSSizeInBytes(), nullptr AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Passive)));
 			this->m_lastPassiveInjectionPeriod = period;
 		}
 	#endif
 
+	#if LAZY_PERIOD_ADVANCEMENT
+		const uint64_t firstIdlePeriod = this->m_periodLog.m_period + 1;
+	#endif
+
 	this->StoreCurrentPeriodLog();
 
+	#if LAZY_PERIOD_ADVANCEMENT
+		if (firstIdlePeriod < period) {
+			this->StoreIdlePeriodLogs(firstIdlePeriod, period);
+		}
+	#endif
+
 	#if MULTIPLE_BER_CONFIGURATION
 		this->m_faultInjector.AdvanceBerIndex();
 	#endif
@@ -159,6 +289,19 @@ uint64_t ApproximateBuffer::GetCurrentPassiveBerMarker() const {
 	return g_currentPeriod;
 }
 
+#if INJECTION_CONTEXT
+	//tags the faults of the next injection call of this thread
+	void ApproximateBuffer::SetInjectionContext(const size_t errorCat, const uint64_t period) {
+		#if FAULT_EVENT_TRACE
+			FaultTrace::SetContext(this->m_id, this->m_initialAddress, this->m_dataSizeInBytes, errorCat, period);
+		#endif
+
+		#if ACCESS_HEATMAP
+			AccessHeatmap::SetContext(&this->m_heatmap, this->m_initialAddress);
+		#endif
+	}
+#endif
+
 size_t ApproximateBuffer::GetSoftwareBufferSizeInBytes() const {
 	return this->size();
 }
@@ -185,15 +328,17 @@ size_t ApproximateBuffer::GetTotalNecessaryReadBackupSize() const {
 
 //MUST LOCK
 bool ApproximateBuffer::GetShouldInject(const size_t errorCat, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) const {
-	return isThreadInjectionEnabled IF_PIN_LOCKED(&& isBufferInThread) && this->m_faultInjector.GetShouldGoOn(errorCat); 
+	return isThreadInjectionEnabled IF_PIN_LOCKED(&& isBufferInThread) IF_PERIOD_SAMPLING(&& this->m_periodLog.m_isSampled) && this->m_faultInjector.GetShouldGoOn(errorCat); 
 }
 
 size_t ApproximateBuffer::GetIndexFromAddress(uint8_t const * const address) const {
-	return ((size_t) (address - this->m_initialAddress)) / this->m_dataSizeInBytes; //static_cast<size_t>
+	const size_t offset = (size_t) (address - this->m_initialAddress); //static_cast<size_t>
+	return (this->m_dataSizeShift != NO_DATA_SIZE_SHIFT) ? (offset >> this->m_dataSizeShift) : (offset / this->m_dataSizeInBytes);
 }
 
 size_t ApproximateBuffer::GetAlignmentOffset(uint8_t const * const address) const {
-	return static_cast<size_t>(address - this->m_initialAddress) % this->m_dataSizeInBytes;
+	const size_t offset = static_cast<size_t>(address - this->m_initialAddress);
+	return (this->m_dataSizeShift != NO_DATA_SIZE_SHIFT) ? (offset & (this->m_dataSizeInBytes - 1)) : (offset % this->m_dataSizeInBytes);
 }
 
 bool ApproximateBuffer::IsMisaligned(uint8_t const * const address) const {
@@ -203,6 +348,57 @@ bool ApproximateBuffer::IsIgnorableMisaligned(uint8_t const * const address, con
 	return this->IsMisaligned(address) && accessSize < this->m_dataSizeInBytes;
 }
 
+#if RANGE_ACCESS_HANDLING
+	//clips the range to the buffer and keeps only the elements it fully covers, as partially accessed elements are ignored by the single element handlers as well
+	bool ApproximateBuffer::GetWholeElementsWithin(uint8_t * const initialAddress, uint8_t const * const finalAddress, uint8_t*& firstElement, uint8_t const *& endElement) const {
+		uint8_t * const clippedInitial = std::max(initialAddress, this->m_initialAddress);
+		uint8_t const * const clippedFinal = std::min(finalAddress, this->m_finalAddress);
+
+		if (clippedInitial >= clippedFinal) {
+			return false;
+		}
+
+		const size_t initialOffset = this->GetAlignmentOffset(clippedInitial);
+		firstElement = clippedInitial + (initialOffset ? (this->m_dataSizeInBytes - initialOffset) : 0);
+		endElement = clippedFinal - this->GetAlignmentOffset(clippedFinal);
+
+		return firstElement < endElement;
+	}
+
+	//WAS LOCKED
+	//the range is split so that each part still fits the 32 bits access size of the SIMD handlers (called through the final type, so not virtually)
+	void ApproximateBuffer::HandleMemoryReadRange(uint8_t * const initialAddress, uint8_t const * const finalAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+		uint8_t* currentAddress;
+		uint8_t const * endAddress;
+		if (!this->GetWholeElementsWithin(initialAddress, finalAddress, currentAddress, endAddress)) {
+			return;
+		}
+
+		const size_t maximumPart = (UINT32_MAX / this->m_dataSizeInBytes) * this->m_dataSizeInBytes;
+		while (currentAddress < endAddress) {
+			const size_t partSize = std::min(static_cast<size_t>(endAddress - currentAddress), maximumPart);
+			static_cast<ChosenTermApproximateBuffer*>(this)->HandleMemoryReadSIMD(currentAddress, static_cast<uint32_t>(partSize), isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+			currentAddress += partSize;
+		}
+	}
+
+	//WAS LOCKED
+	void ApproximateBuffer::HandleMemoryWriteRange(uint8_t * const initialAddress, uint8_t const * const finalAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+		uint8_t* currentAddress;
+		uint8_t const * endAddress;
+		if (!this->GetWholeElementsWithin(initialAddress, finalAddress, currentAddress, endAddress)) {
+			return;
+		}
+
+		const size_t maximumPart = (UINT32_MAX / this->m_dataSizeInBytes) * this->m_dataSizeInBytes;
+		while (currentAddress < endAddress) {
+			const size_t partSize = std::min(static_cast<size_t>(endAddress - currentAddress), maximumPart);
+			static_cast<ChosenTermApproximateBuffer*>(this)->HandleMemoryWriteSIMD(currentAddress, static_cast<uint32_t>(partSize), isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+			currentAddress += partSize;
+		}
+	}
+#endif
+
 #if ENABLE_PASSIVE_INJECTION
 	#if LOG_FAULTS
 		//MUST LOCK
@@ -215,10 +411,34 @@ bool ApproximateBuffer::IsIgnorableMisaligned(uint8_t const * const address, con
 		}
 
 		//MUST LOCK
-		void ApproximateBuffer::AdvanceBufferLogIterator(BufferLogs::const_iterator& it) const {
-			if (it != this->m_bufferLogs.cend()) { //NOTE: map iterators are circular
-				++it;
-			}
+		//the log holding the given period, if stored
+		BufferLogs::const_iterator ApproximateBuffer::FindBufferLog(const uint64_t period) const {
+			#if LAZY_PERIOD_ADVANCEMENT
+				BufferLogs::const_iterator it = this->m_bufferLogs.upper_bound(period); //idle logs may span several periods
+				if (it == this->m_bufferLogs.cbegin()) {
+					return this->m_bufferLogs.cend();
+				}
+
+				--it;
+				return (it->second->GetLastPeriod() >= period) ? it : this->m_bufferLogs.cend();
+			#else
+				return this->m_bufferLogs.find(period);
+			#endif
+		}
+
+		//MUST LOCK
+		//moves to the log of the given period, the one following the iterator's
+		void ApproximateBuffer::AdvanceBufferLogIterator(BufferLogs::const_iterator& it, const uint64_t period) const {
+			#if LAZY_PERIOD_ADVANCEMENT
+				while (it != this->m_bufferLogs.cend() && it->second->GetLastPeriod() < period) {
+					++it;
+				}
+			#else
+				(void) period;
+				if (it != this->m_bufferLogs.cend()) { //NOTE: map iterators are circular
+					++it;
+				}
+			#endif
 		}
 	#endif
 
@@ -250,6 +470,7 @@ bool ApproximateBuffer::IsIgnorableMisaligned(uint8_t const * const address, con
 		#else
 			if (this->GetCurrentPassiveBerMarker() != this->m_lastPassiveInjectionPeriod) {
 				if (this->m_faultInjector.GetShouldGoOn(ErrorCategory::Passive)) {
+					IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Passive, this->m_periodLog.m_period);)
 					this->m_faultInjector.InjectFault(this->m_initialAddress, ErrorCategory::Passive, this->GetSoftwareBufferSSizeInBytes(), nullptr AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Passive)));
 					this->m_lastPassiveInjectionPeriod = g_currentPeriod;
 				}
@@ -261,11 +482,29 @@ bool ApproximateBuffer::IsIgnorableMisaligned(uint8_t const * const address, con
 		//MUST LOCK
 		void ApproximateBuffer::ApplyPassiveFault(uint8_t * const initialAddress, uint8_t const * const finalAddress) {
 			if (this->m_faultInjector.GetShouldGoOn(ErrorCategory::Passive)) {
-				size_t elementIndex = this->GetIndexFromAddress(initialAddress);
+				#if OVERCHARGE_BER
+					size_t elementIndex = this->GetIndexFromAddress(initialAddress);
 
-				for (uint8_t* currentAddress = initialAddress; currentAddress < finalAddress; currentAddress += this->m_dataSizeInBytes, ++elementIndex) {					
-					this->ApplyPassiveFault(elementIndex, currentAddress);
-				}
+					for (uint8_t* currentAddress = initialAddress; currentAddress < finalAddress; currentAddress += this->m_dataSizeInBytes, ++elementIndex) {					
+						this->ApplyPassiveFault(elementIndex, currentAddress);
+					}
+				#else
+					//elements last accessed in the same period are caught up together, one range injection per missed period
+					const size_t firstElementIndex = this->GetIndexFromAddress(initialAddress);
+					const size_t endElementIndex = firstElementIndex + ((static_cast<size_t>(finalAddress - initialAddress) + this->m_dataSizeInBytes - 1) / this->m_dataSizeInBytes);
+
+					for (size_t runStart = firstElementIndex; runStart < endElementIndex; /**/) {
+						const uint64_t runMarker = this->m_lastAccessPeriod[runStart];
+
+						size_t runEnd = runStart + 1;
+						while (runEnd < endElementIndex && this->m_lastAccessPeriod[runEnd] == runMarker) {
+							++runEnd;
+						}
+
+						this->ApplyPassiveFaultRun(runStart, runEnd - runStart, initialAddress + ((runStart - firstElementIndex) * this->m_dataSizeInBytes));
+						runStart = runEnd;
+					}
+				#endif
 			}
 		}
 
@@ -279,6 +518,7 @@ bool ApproximateBuffer::IsIgnorableMisaligned(uint8_t const * const address, con
 
 		//MUST LOCK
 		void ApproximateBuffer::ApplyPassiveFault(const size_t elementIndex, uint8_t * const accessedAddress) {
+			PROFILE_SCOPE(PassiveCatchUp)
 			const uint64_t currentMarker = this->GetCurrentPassiveBerMarker();
 			
 			#if OVERCHARGE_BER
@@ -288,6 +528,7 @@ bool ApproximateBuffer::IsIgnorableMisaligned(uint8_t const * const address, con
 					const auto& ber = this->m_faultInjector.GetBer(ErrorCategory::Passive, initialMarker, currentMarker);
 
 					if (ber || !MULTIPLE_BER_CONFIGURATION) {
+						IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Passive, this->m_periodLog.m_period);)
 						#if OVERCHARGE_FLIP_BACK
 							this->m_faultInjector.InjectFaultOvercharged(accessedAddress, ber);
 						#else
@@ -301,31 +542,86 @@ bool ApproximateBuffer::IsIgnorableMisaligned(uint8_t const * const address, con
 				uint64_t& initialMarker = this->m_lastAccessPeriod[elementIndex];
 
 				#if LOG_FAULTS
-					BufferLogs::const_iterator it = this->m_bufferLogs.find(initialMarker);
+					BufferLogs::const_iterator it = this->FindBufferLog(initialMarker);
+				#endif
+
+				#if MULTIPLE_BER_CONFIGURATION && BER_SCHEDULE
+					BerScheduleCursor berCursor = this->m_faultInjector.GetBerScheduleCursor(ErrorCategory::Passive, initialMarker);
 				#endif
 
 				for (/**/; initialMarker < currentMarker; ++initialMarker) {
 					#if LOG_FAULTS
-						this->AdvanceBufferLogIterator(it);
+						this->AdvanceBufferLogIterator(it, initialMarker + 1);
 						uint64_t* const passiveErrorCount = this->GetPassiveErrorsLogFromIterator(it);
 					#endif
 
 					#if MULTIPLE_BER_CONFIGURATION
-						const auto& ber = this->m_faultInjector.GetBer(ErrorCategory::Passive, this->m_faultInjector.GetBerIndexFromPeriod(initialMarker));
+						#if BER_SCHEDULE
+							const InjectionBer ber = berCursor.Get();
+							berCursor.Advance();
+						#else
+							const auto& ber = this->m_faultInjector.GetBer(ErrorCategory::Passive, this->m_faultInjector.GetBerIndexFromPeriod(initialMarker));
+						#endif
 					#else
-						const auto& ber = this->m_faultInjector.GetBer(ErrorCategory::Passive);
+						const auto& ber = this->m_faultInjector.GetInjectionBer(ErrorCategory::Passive);
 					#endif
 
 					if (ber || !MULTIPLE_BER_CONFIGURATION) { //if MULTIPLE_BER_CONFIGURATION is false, the check is optimized away
+						IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Passive, initialMarker + 1);)
 						this->m_faultInjector.InjectFault(accessedAddress, ber, nullptr AND_LOG_ARGUMENT(passiveErrorCount));
 					}
 				}
 			#endif
 		}
+
+		#if !OVERCHARGE_BER
+			//MUST LOCK
+			//all the elements of the run share the same last access marker
+			void ApproximateBuffer::ApplyPassiveFaultRun(const size_t firstElementIndex, const size_t elementCount, uint8_t * const initialAddress) {
+				PROFILE_SCOPE(PassiveCatchUp)
+				const uint64_t currentMarker = this->GetCurrentPassiveBerMarker();
+				const uint64_t initialMarker = this->m_lastAccessPeriod[firstElementIndex];
+
+				#if LOG_FAULTS
+					BufferLogs::const_iterator it = this->FindBufferLog(initialMarker);
+				#endif
+
+				#if MULTIPLE_BER_CONFIGURATION && BER_SCHEDULE
+					BerScheduleCursor berCursor = this->m_faultInjector.GetBerScheduleCursor(ErrorCategory::Passive, initialMarker);
+				#endif
+
+				for (uint64_t marker = initialMarker; marker < currentMarker; ++marker) {
+					#if LOG_FAULTS
+						this->AdvanceBufferLogIterator(it, marker + 1);
+						uint64_t* const passiveErrorCount = this->GetPassiveErrorsLogFromIterator(it);
+					#endif
+
+					#if MULTIPLE_BER_CONFIGURATION
+						#if BER_SCHEDULE
+							const InjectionBer ber = berCursor.Get();
+							berCursor.Advance();
+						#else
+							const auto& ber = this->m_faultInjector.GetBer(ErrorCategory::Passive, this->m_faultInjector.GetBerIndexFromPeriod(marker));
+						#endif
+					#else
+						const auto& ber = this->m_faultInjector.GetInjectionBer(ErrorCategory::Passive);
+					#endif
+
+					if (ber || !MULTIPLE_BER_CONFIGURATION) {
+						IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Passive, marker + 1);)
+						this->m_faultInjector.InjectFaultRange(initialAddress, elementCount, this->m_dataSizeInBytes, ber, nullptr AND_LOG_ARGUMENT(passiveErrorCount));
+					}
+				}
+
+				if (initialMarker < currentMarker) {
+					std::fill_n(this->m_lastAccessPeriod.get() + firstElementIndex, elementCount, currentMarker);
+				}
+			}
+		#endif
 	#endif
 #endif
 
-void ApproximateBuffer::WriteLogHeaderToFile(std::ofstream& outputLog, const std::string& basePadding /*= ""*/) const {
+void ApproximateBuffer::WriteLogHeaderToFile(std::ostream& outputLog, const std::string& basePadding /*= ""*/) const {
 	const std::string padding = basePadding + '\t';
 	outputLog << basePadding << "BUFFER START" << std::endl;
 	outputLog << padding << "Buffer Id: " << this->m_id << std::endl;
@@ -341,7 +637,7 @@ void ApproximateBuffer::WriteLogHeaderToFile(std::ofstream& outputLog, const std
 }
  
 
-void ApproximateBuffer::WriteAccessLogToFile(std::ofstream& outputLog, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size>& totalTargetAccessesBytes, std::array<uint64_t, ErrorCategory::Size>& totalTargetInjections, const std::string& basePadding) const {
+void ApproximateBuffer::WriteAccessLogToFile(std::ostream& outputLog, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size>& totalTargetAccessesBytes, std::array<ErrorCount, ErrorCategory::Size>& totalTargetInjections IF_COMMA_PERIOD_SAMPLING(SampledBytes& totalTargetSampledBytes), const std::string& basePadding) const {
 	const std::string padding = basePadding + '\t';
 	
 	outputLog << std::endl;
@@ -353,7 +649,7 @@ void ApproximateBuffer::WriteAccessLogToFile(std::ofstream& outputLog, std::arra
 
 	for (const auto& [_, bufLog] : this->m_bufferLogs) {
 		++activePeriodsCount;
-		bufLog->WriteAccessLogToFile(outputLog, this->m_faultInjector.GetBitDepth(), this->m_dataSizeInBytes, bufferAccessedBytes, totalTargetInjections, padding);
+		bufLog->WriteAccessLogToFile(outputLog, this->m_faultInjector.GetBitDepth(), this->m_dataSizeInBytes, bufferAccessedBytes, totalTargetInjections IF_COMMA_PERIOD_SAMPLING(totalTargetSampledBytes) IF_COMMA_ANALYTIC_ERROR_EXPECTATION(this->m_faultInjector) IF_COMMA_ANALYTIC_ERROR_EXPECTATION(this->GetNumberOfElements()), padding);
 	}
 
 	outputLog << padding << "BUFFER TOTALS" << std::endl;
@@ -370,7 +666,7 @@ void ApproximateBuffer::WriteAccessLogToFile(std::ofstream& outputLog, std::arra
 	outputLog << basePadding << "BUFFER END" << std::endl;
 }
 
-void ApproximateBuffer::WriteEnergyLogToFile(std::ofstream& outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& totalTargetEnergy, const ConsumptionProfile& respectiveConsumptionProfile, const std::string& basePadding) const {
+void ApproximateBuffer::WriteEnergyLogToFile(std::ostream& outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& totalTargetEnergy, const ConsumptionProfile& respectiveConsumptionProfile, const std::string& basePadding) const {
 	const std::string padding = basePadding + '\t';
 	
 	outputLog << std::endl;
@@ -416,6 +712,10 @@ ShortTermApproximateBuffer::~ShortTermApproximateBuffer() {
 bool ShortTermApproximateBuffer::RetireBuffer(const bool giveAwayRecords) {
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
+	#if LAZY_PERIOD_ADVANCEMENT
+		this->CatchUpPeriod();
+	#endif
+
 	if (this->m_isActive >= 1) { //if there's at least one thread using it...
 		this->m_isActive--;
 
@@ -443,6 +743,7 @@ bool ShortTermApproximateBuffer::RetireBuffer(const bool giveAwayRecords) {
 
 //MUST LOCK
 void ShortTermApproximateBuffer::BackupReadData(uint8_t* const data) {
+	PROFILE_SCOPE(BackupReadData)
 	uint8_t * const readBackup = new uint8_t[this->m_minimumReadBackupSize];
 	std::copy_n(data, this->m_minimumReadBackupSize, readBackup);
 	this->m_remainingReads.insert(this->m_readHint, {data, readBackup});
@@ -480,7 +781,7 @@ auto ShortTermApproximateBuffer::GetWriteBerFromIterator(const PendingWrites::co
 		#endif
 	#else
 		#if !DISTANCE_BASED_FAULT_INJECTOR
-			return this->m_faultInjector.GetBer(ErrorCategory::Write);
+			return this->m_faultInjector.GetInjectionBer(ErrorCategory::Write);
 		#else
 			return this->m_faultInjector.GetInjectorRecord(ErrorCategory::Write);
 		#endif
@@ -503,6 +804,7 @@ PendingWrites::const_iterator ShortTermApproximateBuffer::ApplyFaultyWrite(const
 	uint8_t* const address = ShortTermApproximateBuffer::GetWriteAddressFromIterator(it);
 	const auto ber = ShortTermApproximateBuffer::GetWriteBerFromIterator(it); 
 
+	IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Write, this->m_periodLog.m_period);)
 	#if !DISTANCE_BASED_FAULT_INJECTOR
 		this->m_faultInjector.InjectFault(address, ber, nullptr AND_LOG_ARGUMENT(ShortTermApproximateBuffer::GetWriteErrorsLogFromIterator(it)));
 	#else
@@ -514,6 +816,7 @@ PendingWrites::const_iterator ShortTermApproximateBuffer::ApplyFaultyWrite(const
 
 //MUST LOCK
 void ShortTermApproximateBuffer::ApplyFaultyWrite(uint8_t * const accessedAddress) {
+	PROFILE_SCOPE(ApplyFaultyWrite)
 	const PendingWrites::const_iterator it = this->m_pendingWrites.lower_bound(accessedAddress);
 	if (it != this->m_pendingWrites.cend())	{
 		this->ApplyFaultyWrite(it);
@@ -522,6 +825,7 @@ void ShortTermApproximateBuffer::ApplyFaultyWrite(uint8_t * const accessedAddres
 
 //MUST LOCK
 void ShortTermApproximateBuffer::ApplyFaultyWrite(uint8_t * const initialAddress, uint8_t const * const finalAddress) {
+	PROFILE_SCOPE(ApplyFaultyWrite)
 	PendingWrites::const_iterator lowerIt = this->m_pendingWrites.lower_bound(initialAddress);
 	#if MULTIPLE_BER_CONFIGURATION || LOG_FAULTS
 		while (lowerIt != this->m_pendingWrites.cend() && lowerIt->first	< finalAddress)
@@ -535,23 +839,47 @@ void ShortTermApproximateBuffer::ApplyFaultyWrite(uint8_t * const initialAddress
 
 //MUST LOCK
 void ShortTermApproximateBuffer::ApplyAllWriteErrors() {
-	for (PendingWrites::const_iterator it = this->m_pendingWrites.cbegin(); it != this->m_pendingWrites.cend(); /**/) {
-		it = this->ApplyFaultyWrite(it);
-	}
+	#if !DISTANCE_BASED_FAULT_INJECTOR
+		//contiguous pending writes that share their BER (and log) are injected as a single range
+		for (PendingWrites::const_iterator runStart = this->m_pendingWrites.cbegin(); runStart != this->m_pendingWrites.cend(); /**/) {
+			uint8_t* const initialAddress = ShortTermApproximateBuffer::GetWriteAddressFromIterator(runStart);
+			const auto ber = this->GetWriteBerFromIterator(runStart);
+
+			size_t elementCount = 1;
+			PendingWrites::const_iterator runEnd = std::next(runStart);
+			while (runEnd != this->m_pendingWrites.cend() && ShortTermApproximateBuffer::GetWriteAddressFromIterator(runEnd) == initialAddress + (elementCount * this->m_dataSizeInBytes) && this->GetWriteBerFromIterator(runEnd) == ber) {
+				#if LOG_FAULTS
+					if (ShortTermApproximateBuffer::GetWriteErrorsLogFromIterator(runEnd) != ShortTermApproximateBuffer::GetWriteErrorsLogFromIterator(runStart)) {
+						break;
+					}
+				#endif
+				++runEnd;
+				++elementCount;
+			}
+
+			IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Write, this->m_periodLog.m_period);)
+			this->m_faultInjector.InjectFaultRange(initialAddress, elementCount, this->m_dataSizeInBytes, ber, nullptr AND_LOG_ARGUMENT(ShortTermApproximateBuffer::GetWriteErrorsLogFromIterator(runStart)));
+			runStart = this->m_pendingWrites.erase(runStart, runEnd);
+		}
+	#else
+		for (PendingWrites::const_iterator it = this->m_pendingWrites.cbegin(); it != this->m_pendingWrites.cend(); /**/) {
+			it = this->ApplyFaultyWrite(it);
+		}
+	#endif
 }
 
 //MUST LOCK
-void ShortTermApproximateBuffer::RecordFaultyWrite(uint8_t* const address, PendingWrites::const_iterator& hint) {
+void ShortTermApproximateBuffer::RecordFaultyWrite(uint8_t* const address, PendingWrites::const_iterator& hint IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	#if MULTIPLE_BER_CONFIGURATION
 		#if LOG_FAULTS
 			#if !DISTANCE_BASED_FAULT_INJECTOR
-				const auto& insertedValue = std::make_pair(this->m_faultInjector.GetBer(ErrorCategory::Write), this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Write));
+				const auto& insertedValue = std::make_pair(this->m_faultInjector.GetInjectionBer(ErrorCategory::Write), this->GetAccessErrorCountsByBit(ErrorCategory::Write IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts)));
 			#else
-				std::pair<DistanceBasedInjectorRecord*, uint64_t*> insertedValue = std::make_pair(this->m_faultInjector.GetInjectorRecord(ErrorCategory::Write), this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Write));
+				std::pair<DistanceBasedInjectorRecord*, uint64_t*> insertedValue = std::make_pair(this->m_faultInjector.GetInjectorRecord(ErrorCategory::Write), this->GetAccessErrorCountsByBit(ErrorCategory::Write IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts)));
 			#endif
 		#else
 			#if !DISTANCE_BASED_FAULT_INJECTOR
-				const auto& insertedValue = this->m_faultInjector.GetBer(ErrorCategory::Write);
+				const auto& insertedValue = this->m_faultInjector.GetInjectionBer(ErrorCategory::Write);
 			#else
 				DistanceBasedInjectorRecord* insertedValue = this->m_faultInjector.GetInjectorRecord(ErrorCategory::Write);
 			#endif
@@ -560,7 +888,7 @@ void ShortTermApproximateBuffer::RecordFaultyWrite(uint8_t* const address, Pendi
 		hint = this->m_pendingWrites.insert_or_assign(hint, address, insertedValue);
 	#else
 		#if LOG_FAULTS
-			hint = this->m_pendingWrites.insert_or_assign(hint, address, this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Write));
+			hint = this->m_pendingWrites.insert_or_assign(hint, address, this->GetAccessErrorCountsByBit(ErrorCategory::Write IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts)));
 		#else
 			hint = this->m_pendingWrites.insert(hint, address);
 		#endif
@@ -578,6 +906,7 @@ RemainingReads::const_iterator ShortTermApproximateBuffer::ReverseFaultyRead(con
 
 //MUST LOCK
 RemainingReads::const_iterator ShortTermApproximateBuffer::ReverseFaultyRead(uint8_t * const accessedAddress) {
+	PROFILE_SCOPE(ReverseFaultyRead)
 	RemainingReads::const_iterator it = this->m_remainingReads.find(accessedAddress);
 	if (it != this->m_remainingReads.cend()) {
 		it = this->ReverseFaultyRead(it);
@@ -587,6 +916,7 @@ RemainingReads::const_iterator ShortTermApproximateBuffer::ReverseFaultyRead(uin
 
 //MUST LOCK
 RemainingReads::const_iterator ShortTermApproximateBuffer::ReverseFaultyRead(uint8_t * const initialAddress, uint8_t const * const finalAddress) {
+	PROFILE_SCOPE(ReverseFaultyRead)
 	RemainingReads::const_iterator lowerIt = this->m_remainingReads.lower_bound(initialAddress); 
 	while (lowerIt != this->m_remainingReads.cend() && lowerIt->first < finalAddress) {
 		lowerIt = this->ReverseFaultyRead(lowerIt);
@@ -624,12 +954,14 @@ void ShortTermApproximateBuffer::InvalidateRemainingRead(uint8_t * const initial
 }
 
 //WAS LOCKED
-void ShortTermApproximateBuffer::HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void ShortTermApproximateBuffer::HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	uint8_t const * const finalAddress = initialAddress + accessSize;
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 	
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Write, accessSize);
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Write, accessSize);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(initialAddress, AccessTypes::Write, accessSize);)
+	PROFILE_SIMD_ELEMENTS(accessSize / this->m_dataSizeInBytes)
 
 	this->InvalidateRemainingRead(initialAddress, finalAddress);
 
@@ -640,7 +972,7 @@ void ShortTermApproximateBuffer::HandleMemoryWriteSIMD(uint8_t * const initialAd
 	if (this->GetShouldInject(ErrorCategory::Write, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread))) {
 		PendingWrites::const_iterator hint = this->m_pendingWrites.lower_bound(initialAddress);
 		for (uint8_t* currentAddress = initialAddress; currentAddress < finalAddress; currentAddress += this->m_dataSizeInBytes) {
-			this->RecordFaultyWrite(currentAddress, hint);
+			this->RecordFaultyWrite(currentAddress, hint IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 		}
 	}
 
@@ -648,24 +980,25 @@ void ShortTermApproximateBuffer::HandleMemoryWriteSIMD(uint8_t * const initialAd
 }
 
 //WAS LOCKED
-void ShortTermApproximateBuffer::HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void ShortTermApproximateBuffer::HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	if (this->IsIgnorableMisaligned(accessedAddress, accessSize)) {
 		return;
 	}
 
 	if (accessSize > this->m_dataSizeInBytes) {
-		this->HandleMemoryWriteSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+		this->HandleMemoryWriteSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 		return;
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
-	this->HandleMemoryWriteSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+	this->HandleMemoryWriteSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
 }
 
 //WAS LOCKED
-void ShortTermApproximateBuffer::HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Write, this->m_dataSizeInBytes);
+void ShortTermApproximateBuffer::HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Write, this->m_dataSizeInBytes);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(accessedAddress, AccessTypes::Write, this->m_dataSizeInBytes);)
 
 	this->InvalidateRemainingRead(accessedAddress);
 
@@ -675,29 +1008,31 @@ void ShortTermApproximateBuffer::HandleMemoryWriteSingleElementUnsafe(uint8_t *
 
 	if (this->GetShouldInject(ErrorCategory::Write, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread))) {
 		PendingWrites::const_iterator hint = this->m_pendingWrites.lower_bound(accessedAddress);
-		this->RecordFaultyWrite(accessedAddress, hint);
+		this->RecordFaultyWrite(accessedAddress, hint IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	}
 }
 
 //WAS LOCKED
-void ShortTermApproximateBuffer::HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void ShortTermApproximateBuffer::HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
 	for (UINT32 i = 0; i < memOpInfo->NumOfElements(); ++i) {
 		uint8_t * const accessedAddress = (uint8_t*) memOpInfo->ElementAddress(i); //it could also be implemented in something along the lines of SIMD version, but it'd also trigger pendings and remainings in between, also i'm lazy right now and don't even know why i still maintain this term approach
-		this->HandleMemoryWriteSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+		this->HandleMemoryWriteSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
 }
 
 //WAS LOCKED
-void ShortTermApproximateBuffer::HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void ShortTermApproximateBuffer::HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	uint8_t const * const finalAddress = initialAddress + accessSize;
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Read, accessSize);
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Read, accessSize);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(initialAddress, AccessTypes::Read, accessSize);)
+	PROFILE_SIMD_ELEMENTS(accessSize / this->m_dataSizeInBytes)
 	
 	this->m_readHint = this->ReverseFaultyRead(initialAddress, finalAddress);
 
@@ -708,12 +1043,12 @@ void ShortTermApproximateBuffer::HandleMemoryReadSIMD(uint8_t * const initialAdd
 	#endif
 
 	if (this->GetShouldInject(ErrorCategory::Read, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread))) {		
+		IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Read, this->m_periodLog.m_period);)
 		#if !DISTANCE_BASED_FAULT_INJECTOR
-			for (uint8_t* currentAddress = initialAddress; currentAddress < finalAddress; currentAddress += this->m_dataSizeInBytes) {
-				this->m_faultInjector.InjectFault(currentAddress, this->m_faultInjector.GetBer(ErrorCategory::Read), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
-			}
+			const size_t accessedElementCount = (accessSize + this->m_dataSizeInBytes - 1) / this->m_dataSizeInBytes;
+			this->m_faultInjector.InjectFaultRange(initialAddress, accessedElementCount, this->m_dataSizeInBytes, this->m_faultInjector.GetInjectionBer(ErrorCategory::Read), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
 		#else
-			this->m_faultInjector.InjectFault(initialAddress, ErrorCategory::Read, static_cast<ssize_t>(accessSize), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
+			this->m_faultInjector.InjectFault(initialAddress, ErrorCategory::Read, static_cast<ssize_t>(accessSize), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
 		#endif
 	}
 
@@ -721,24 +1056,25 @@ void ShortTermApproximateBuffer::HandleMemoryReadSIMD(uint8_t * const initialAdd
 }
 
 //WAS LOCKED
-void ShortTermApproximateBuffer::HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void ShortTermApproximateBuffer::HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	if (this->IsIgnorableMisaligned(accessedAddress, accessSize)) {
 		return;
 	}
 
 	if (accessSize > this->m_dataSizeInBytes) {
-		this->HandleMemoryReadSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+		this->HandleMemoryReadSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 		return;
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
-	this->HandleMemoryReadSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+	this->HandleMemoryReadSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
 }
 
 //MUST LOCK
-void ShortTermApproximateBuffer::HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Read, this->m_dataSizeInBytes);
+void ShortTermApproximateBuffer::HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Read, this->m_dataSizeInBytes);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(accessedAddress, AccessTypes::Read, this->m_dataSizeInBytes);)
 
 	this->m_readHint = this->ReverseFaultyRead(accessedAddress);
 
@@ -749,21 +1085,22 @@ void ShortTermApproximateBuffer::HandleMemoryReadSingleElementUnsafe(uint8_t * c
 	#endif
 
 	if (this->GetShouldInject(ErrorCategory::Read, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread))) {		
+		IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Read, this->m_periodLog.m_period);)
 		#if !DISTANCE_BASED_FAULT_INJECTOR
-			this->m_faultInjector.InjectFault(accessedAddress, this->m_faultInjector.GetBer(ErrorCategory::Read), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
+			this->m_faultInjector.InjectFault(accessedAddress, this->m_faultInjector.GetInjectionBer(ErrorCategory::Read), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
 		#else
-			this->m_faultInjector.InjectFault(accessedAddress, ErrorCategory::Read, static_cast<ssize_t>(this->m_dataSizeInBytes), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
+			this->m_faultInjector.InjectFault(accessedAddress, ErrorCategory::Read, static_cast<ssize_t>(this->m_dataSizeInBytes), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
 		#endif
 	}
 }
 
 //WAS LOCKED
-void ShortTermApproximateBuffer::HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void ShortTermApproximateBuffer::HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
 	for (UINT32 i = 0; i < memOpInfo->NumOfElements(); ++i) {
 		uint8_t * const accessedAddress = (uint8_t*) memOpInfo->ElementAddress(i); //it could also be implemented in something along the lines of SIMD version, but it'd also trigger pendings and remainings in between, also i'm lazy right now and don't even know why i still maintain this term approach
-		this->HandleMemoryReadSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+		this->HandleMemoryReadSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
@@ -855,16 +1192,20 @@ void LongTermApproximateBuffer::GiveAwayRecordsAndBackups(const bool giveAwayRec
 bool LongTermApproximateBuffer::RetireBuffer(const bool giveAwayRecords) {
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
+	#if LAZY_PERIOD_ADVANCEMENT
+		this->CatchUpPeriod();
+	#endif
+
 	if (this->m_isActive >= 1) { //if there's at least one thread using it...
 		this->m_isActive--;
 
 		if (this->m_isActive == 0) { //failsafe against repeated retirements
 			uint8_t* address = this->m_initialAddress;
 			for (size_t elementIndex = 0; elementIndex < this->GetNumberOfElements(); ++elementIndex, address += this->m_dataSizeInBytes) {
-				this->ProcessReadMemoryElement(elementIndex, address, false);
+				this->RestoreMemoryElement(elementIndex, address);
 			}		
 
-			#if ENABLE_PASSIVE_INJECTION && DISTANCE_BASED_FAULT_INJECTOR //otherwise, applied by the loop above
+			#if ENABLE_PASSIVE_INJECTION
 				this->ApplyAllPassiveErrors(); 
 			#endif
 
@@ -898,17 +1239,17 @@ void LongTermApproximateBuffer::ReactivateBuffer(const uint64_t period) {
 }
 
 //MUST LOCK
-void LongTermApproximateBuffer::RecordFaultyWrite(const size_t elementIndex) {
+void LongTermApproximateBuffer::RecordFaultyWrite(const size_t elementIndex IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	#if MULTIPLE_BER_CONFIGURATION
 		#if !DISTANCE_BASED_FAULT_INJECTOR
-			this->m_writeSupportRecords[elementIndex].writeSupport = this->m_faultInjector.GetBer(ErrorCategory::Write);
+			this->m_writeSupportRecords[elementIndex].writeSupport = this->m_faultInjector.GetInjectionBer(ErrorCategory::Write);
 		#else
 			this->m_writeSupportRecords[elementIndex].writeSupport = this->m_faultInjector.GetInjectorRecord(ErrorCategory::Write);
 		#endif
 	#endif
 
 	#if LOG_FAULTS
-		this->m_writeSupportRecords[elementIndex].writeErrorsCountByBit	= this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Write);
+		this->m_writeSupportRecords[elementIndex].writeErrorsCountByBit	= this->GetAccessErrorCountsByBit(ErrorCategory::Write IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	#endif
 }
 
@@ -918,6 +1259,7 @@ uint8_t* LongTermApproximateBuffer::GetBackupAddressFromIndex(const size_t index
 
 //MUST LOCK
 void LongTermApproximateBuffer::ReverseFaultyRead(const size_t elementIndex, uint8_t* const accessedAddress) {
+	PROFILE_SCOPE(ReverseFaultyRead)
 	std::copy_n(this->GetBackupAddressFromIndex(elementIndex), this->m_minimumReadBackupSize, accessedAddress);
 }
 
@@ -927,7 +1269,7 @@ auto LongTermApproximateBuffer::GetWriteBer(const size_t elementIndex) {
 		#if MULTIPLE_BER_CONFIGURATION 
 			return this->m_writeSupportRecords[elementIndex].writeSupport;
 		#else
-			return this->m_faultInjector.GetBer(ErrorCategory::Write);
+			return this->m_faultInjector.GetInjectionBer(ErrorCategory::Write);
 		#endif
 	#else
 		#if MULTIPLE_BER_CONFIGURATION
@@ -940,18 +1282,21 @@ auto LongTermApproximateBuffer::GetWriteBer(const size_t elementIndex) {
 
 //MUST LOCK
 void LongTermApproximateBuffer::ApplyWriteFault(const size_t elementIndex, uint8_t* const accessedAddress) {
+	PROFILE_SCOPE(ApplyFaultyWrite)
 	auto ber = this->GetWriteBer(elementIndex);
 
 	#if OVERCHARGE_BER 
 		ber += this->m_faultInjector.GetBer(ErrorCategory::Passive, this->m_lastAccessPeriod[elementIndex], this->GetCurrentPassiveBerMarker());
 		this->m_lastAccessPeriod[elementIndex] = this->GetCurrentPassiveBerMarker();
 
+		IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Write, this->m_periodLog.m_period);)
 		#if OVERCHARGE_FLIP_BACK
 			this->m_faultInjector.InjectFaultOvercharged(accessedAddress, ber);
 		#else
 			this->m_faultInjector.InjectFault(accessedAddress, ber, nullptr);
 		#endif
 	#else
+		IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Write, this->m_periodLog.m_period);)
 		#if !DISTANCE_BASED_FAULT_INJECTOR
 			this->m_faultInjector.InjectFault(accessedAddress, ber, nullptr AND_LOG_ARGUMENT(this->m_writeSupportRecords[elementIndex].writeErrorsCountByBit));
 		#else
@@ -963,6 +1308,7 @@ void LongTermApproximateBuffer::ApplyWriteFault(const size_t elementIndex, uint8
 
 //MUST LOCK
 void LongTermApproximateBuffer::BackupReadData(uint8_t* const data) {
+	PROFILE_SCOPE(BackupReadData)
 	const size_t elementIndex = this->GetIndexFromAddress(data);
 	uint8_t* const backupAddress = this->GetBackupAddressFromIndex(elementIndex);
 	std::copy_n(data, this->m_minimumReadBackupSize, backupAddress);
@@ -970,7 +1316,7 @@ void LongTermApproximateBuffer::BackupReadData(uint8_t* const data) {
 }
 
 //MUST LOCK
-void LongTermApproximateBuffer::ProcessWrittenMemoryElement(const size_t elementIndex, const uint8_t newStatus, const bool shouldInject) {
+void LongTermApproximateBuffer::ProcessWrittenMemoryElement(const size_t elementIndex, const uint8_t newStatus, const bool shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	this->m_records[elementIndex].errorStatus = newStatus;
 
 	#if ENABLE_PASSIVE_INJECTION && !DISTANCE_BASED_FAULT_INJECTOR
@@ -979,13 +1325,13 @@ void LongTermApproximateBuffer::ProcessWrittenMemoryElement(const size_t element
 
 	#if MULTIPLE_BER_CONFIGURATION || LOG_FAULTS
 		if (shouldInject) {
-			this->RecordFaultyWrite(elementIndex);
+			this->RecordFaultyWrite(elementIndex IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 		}
 	#endif
 }
 
 //MUST LOCK
-void LongTermApproximateBuffer::ProcessReadMemoryElement(const size_t elementIndex, uint8_t* const accessedAddress, const bool shouldInject) {
+void LongTermApproximateBuffer::RestoreMemoryElement(const size_t elementIndex, uint8_t* const accessedAddress) {
 	uint8_t& currentErrorStatus = this->m_records[elementIndex].errorStatus;
 
 	if (currentErrorStatus != ErrorStatus::None) {
@@ -996,6 +1342,11 @@ void LongTermApproximateBuffer::ProcessReadMemoryElement(const size_t elementInd
 		}
 		currentErrorStatus = ErrorStatus::None;
 	}
+}
+
+//MUST LOCK
+void LongTermApproximateBuffer::ProcessReadMemoryElement(const size_t elementIndex, uint8_t* const accessedAddress, const bool shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+	this->RestoreMemoryElement(elementIndex, accessedAddress);
 
 	#if ENABLE_PASSIVE_INJECTION && !DISTANCE_BASED_FAULT_INJECTOR
 		this->ApplyPassiveFault(elementIndex, accessedAddress);
@@ -1003,26 +1354,29 @@ void LongTermApproximateBuffer::ProcessReadMemoryElement(const size_t elementInd
 
 	#if !DISTANCE_BASED_FAULT_INJECTOR //outside of the function to avoid constant rechecking during SIMD or Scattered, must be added
 		if (shouldInject) {
-			this->m_faultInjector.InjectFault(accessedAddress, this->m_faultInjector.GetBer(ErrorCategory::Read), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
+			IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Read, this->m_periodLog.m_period);)
+			this->m_faultInjector.InjectFault(accessedAddress, this->m_faultInjector.GetInjectionBer(ErrorCategory::Read), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
 		}
 	#endif
 }
 
 //WAS LOCKED
-void LongTermApproximateBuffer::HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void LongTermApproximateBuffer::HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	const size_t firstElementIndex = this->GetIndexFromAddress(initialAddress);
 	const size_t accessedElementCount = accessSize / this->m_dataSizeInBytes;
 	const size_t endElementIndex = firstElementIndex + accessedElementCount;
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Write, accessSize);
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Write, accessSize);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(initialAddress, AccessTypes::Write, accessSize);)
+	PROFILE_SIMD_ELEMENTS(accessSize / this->m_dataSizeInBytes)
 
 	const bool shouldInject = this->GetShouldInject(ErrorCategory::Write, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
 	const uint8_t newStatus = (shouldInject ? ErrorStatus::Write : ErrorStatus::None);
 
 	for (size_t elementIndex = firstElementIndex; elementIndex < endElementIndex; ++elementIndex) {
-		this->ProcessWrittenMemoryElement(elementIndex, newStatus, shouldInject);
+		this->ProcessWrittenMemoryElement(elementIndex, newStatus, shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
@@ -1030,36 +1384,37 @@ void LongTermApproximateBuffer::HandleMemoryWriteSIMD(uint8_t * const initialAdd
 
 
 //WAS LOCKED
-void LongTermApproximateBuffer::HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void LongTermApproximateBuffer::HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	if (this->IsIgnorableMisaligned(accessedAddress, accessSize)) {
 		return;
 	}
 
 	if (accessSize > this->m_dataSizeInBytes) {
-		this->HandleMemoryWriteSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+		this->HandleMemoryWriteSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 		return;
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
-	this->HandleMemoryWriteSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+	this->HandleMemoryWriteSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
 }
 
-void LongTermApproximateBuffer::HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Write, this->m_dataSizeInBytes);
+void LongTermApproximateBuffer::HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Write, this->m_dataSizeInBytes);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(accessedAddress, AccessTypes::Write, this->m_dataSizeInBytes);)
 
 	const size_t elementIndex = this->GetIndexFromAddress(accessedAddress);
 	const bool shouldInject = this->GetShouldInject(ErrorCategory::Write, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
 	const uint8_t newStatus = (shouldInject ? ErrorStatus::Write : ErrorStatus::None);
 
-	this->ProcessWrittenMemoryElement(elementIndex, newStatus, shouldInject);
+	this->ProcessWrittenMemoryElement(elementIndex, newStatus, shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 }
 
 //WAS LOCKED
-void LongTermApproximateBuffer::HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void LongTermApproximateBuffer::HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Write, this->m_dataSizeInBytes * memOpInfo->NumOfElements());
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Write, this->m_dataSizeInBytes * memOpInfo->NumOfElements());
 
 	const bool shouldInject = this->GetShouldInject(ErrorCategory::Write, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
 	const uint8_t newStatus = (shouldInject ? ErrorStatus::Write : ErrorStatus::None);
@@ -1067,86 +1422,101 @@ void LongTermApproximateBuffer::HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAN
 	for (UINT32 i = 0; i < memOpInfo->NumOfElements(); ++i) {
 		uint8_t * const accessedAddress = (uint8_t*) memOpInfo->ElementAddress(i);
 		const size_t elementIndex = this->GetIndexFromAddress(accessedAddress);
+		IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(accessedAddress, AccessTypes::Write, this->m_dataSizeInBytes);)
 
-		this->ProcessWrittenMemoryElement(elementIndex, newStatus, shouldInject);
+		this->ProcessWrittenMemoryElement(elementIndex, newStatus, shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
 }
 
 //WAS LOCKED
-void LongTermApproximateBuffer::HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void LongTermApproximateBuffer::HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	const size_t firstElementIndex = this->GetIndexFromAddress(initialAddress);
 	uint8_t* currentAddress = initialAddress;
 	uint8_t const * const finalAddress = initialAddress + accessSize;
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Read, accessSize);
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Read, accessSize);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(initialAddress, AccessTypes::Read, accessSize);)
+	PROFILE_SIMD_ELEMENTS(accessSize / this->m_dataSizeInBytes)
 
 	const bool shouldInject = this->GetShouldInject(ErrorCategory::Read, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread)); 
 
 	for (size_t currentElementIndex = firstElementIndex; currentAddress < finalAddress; ++currentElementIndex, currentAddress += this->m_dataSizeInBytes) {
-		this->ProcessReadMemoryElement(currentElementIndex, currentAddress, shouldInject);
+		this->RestoreMemoryElement(currentElementIndex, currentAddress);
 	}
 
-	#if DISTANCE_BASED_FAULT_INJECTOR //outside of the loop to avoid constant rechecking
-		if (shouldInject) {
-			this->m_faultInjector.InjectFault(initialAddress, ErrorCategory::Read, static_cast<ssize_t>(accessSize), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
-		}
+	#if ENABLE_PASSIVE_INJECTION && !DISTANCE_BASED_FAULT_INJECTOR
+		this->ApplyPassiveFault(initialAddress, finalAddress);
 	#endif
 
+	if (shouldInject) { //outside of the loop to avoid constant rechecking
+		IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Read, this->m_periodLog.m_period);)
+		#if !DISTANCE_BASED_FAULT_INJECTOR
+			const size_t accessedElementCount = (accessSize + this->m_dataSizeInBytes - 1) / this->m_dataSizeInBytes;
+			this->m_faultInjector.InjectFaultRange(initialAddress, accessedElementCount, this->m_dataSizeInBytes, this->m_faultInjector.GetInjectionBer(ErrorCategory::Read), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
+		#else
+			this->m_faultInjector.InjectFault(initialAddress, ErrorCategory::Read, static_cast<ssize_t>(accessSize), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
+		#endif
+	}
+
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
 }
 
 //WAS LOCKED
-void LongTermApproximateBuffer::HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void LongTermApproximateBuffer::HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	if (this->IsIgnorableMisaligned(accessedAddress, accessSize)) {
 		return;
 	}
 
 	if (accessSize > this->m_dataSizeInBytes) {
-		this->HandleMemoryReadSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+		this->HandleMemoryReadSIMD(accessedAddress, accessSize, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 		return;
 	}
 
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
-	this->HandleMemoryReadSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
+	this->HandleMemoryReadSingleElementUnsafe(accessedAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 	//IF_PIN_PRIVATE_LOCKED(PIN_ReleaseLock(&this->m_bufferLock);)
 }
 
-void LongTermApproximateBuffer::HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Read, this->m_dataSizeInBytes);
+void LongTermApproximateBuffer::HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Read, this->m_dataSizeInBytes);
+	IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(accessedAddress, AccessTypes::Read, this->m_dataSizeInBytes);)
 
 	const size_t elementIndex = this->GetIndexFromAddress(accessedAddress);
 	const bool shouldInject = this->GetShouldInject(ErrorCategory::Read, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
 
-	this->ProcessReadMemoryElement(elementIndex, accessedAddress, shouldInject);
+	this->ProcessReadMemoryElement(elementIndex, accessedAddress, shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 
 	#if DISTANCE_BASED_FAULT_INJECTOR
 		if (shouldInject) {
-			this->m_faultInjector.InjectFault(accessedAddress, ErrorCategory::Read, static_cast<ssize_t>(this->m_dataSizeInBytes), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
+			IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Read, this->m_periodLog.m_period);)
+			this->m_faultInjector.InjectFault(accessedAddress, ErrorCategory::Read, static_cast<ssize_t>(this->m_dataSizeInBytes), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
 		}
 	#endif
 }
 
 //WAS LOCKED
-void LongTermApproximateBuffer::HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) {
+void LongTermApproximateBuffer::HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
 	//IF_PIN_PRIVATE_LOCKED(PIN_GetLock(&this->m_bufferLock, -1);)
 
-	this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), AccessTypes::Read, this->m_dataSizeInBytes * memOpInfo->NumOfElements());
+	this->IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts), AccessTypes::Read, this->m_dataSizeInBytes * memOpInfo->NumOfElements());
 
 	const bool shouldInject = this->GetShouldInject(ErrorCategory::Read, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread));
 
 	for (UINT32 i = 0; i < memOpInfo->NumOfElements(); ++i) {
 		uint8_t * const accessedAddress = (uint8_t*) memOpInfo->ElementAddress(i);
 		const size_t elementIndex = this->GetIndexFromAddress(accessedAddress);
+		IF_ACCESS_HEATMAP(this->RecordHeatmapAccess(accessedAddress, AccessTypes::Read, this->m_dataSizeInBytes);)
 
-		this->ProcessReadMemoryElement(elementIndex, accessedAddress, shouldInject);
+		this->ProcessReadMemoryElement(elementIndex, accessedAddress, shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
 
 		#if DISTANCE_BASED_FAULT_INJECTOR //has to be here due to non-contiguos access
 			if (shouldInject) {
-				this->m_faultInjector.InjectFault(accessedAddress, ErrorCategory::Read, static_cast<ssize_t>(this->m_dataSizeInBytes), this AND_LOG_ARGUMENT(this->m_periodLog.GetErrorCountsByBit(ErrorCategory::Read)));
+				IF_INJECTION_CONTEXT(this->SetInjectionContext(ErrorCategory::Read, this->m_periodLog.m_period);)
+				this->m_faultInjector.InjectFault(accessedAddress, ErrorCategory::Read, static_cast<ssize_t>(this->m_dataSizeInBytes), this AND_LOG_ARGUMENT(this->GetAccessErrorCountsByBit(ErrorCategory::Read IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts))));
 			}
 		#endif
 	}
@@ -9,6 +9,7 @@ class FaultInjector;
 #include <set>
 #include <map>
 #include <unordered_map>
+#include <vector>
 #include <stdlib.h> 
 #include <algorithm>
 #include <fstream>
@@ -19,6 +20,7 @@ class FaultInjector;
 #include "injector-configuration.h"
 #include "fault-injector.h"
 #include "consumption-profile.h"
+#include "shadow-memory.h"
 
 //extern bool g_isGlobalInjectionEnabled;
 //extern int g_level;
@@ -62,11 +64,16 @@ class ApproximateBuffer : public Range {
 	protected:
 		const int64_t m_id;
 		const size_t m_dataSizeInBytes;
+		const size_t m_dataSizeShift; //log2 of m_dataSizeInBytes when it is a power of two (NO_DATA_SIZE_SHIFT otherwise), spares the division when indexing elements
 		const size_t m_minimumReadBackupSize;
 		uint64_t m_creationPeriod;
 		//PIN_LOCK m_bufferLock;
 		int32_t m_isActive;
 
+		#if PERSISTENT_COUNTERS
+			const uint64_t m_persistentRecord; //offset of the buffer's record in the persistent counters file
+		#endif
+
 		#if DISTANCE_BASED_FAULT_INJECTOR
 			DistanceBasedFaultInjector m_faultInjector;
 		#elif GRANULAR_FAULT_INJECTOR
@@ -78,6 +85,54 @@ class ApproximateBuffer : public Range {
 		PeriodLog m_periodLog;
 		BufferLogs m_bufferLogs;
 
+		#if THREAD_PRIVATE_ACCESS_COUNTING
+			std::vector<std::pair<THREADID, std::unique_ptr<ThreadAccessCounts>>> m_threadAccessCounts; //one per thread that accessed the buffer, allocated on its first access and kept across reactivations
+		#endif
+
+		#if PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS
+			uint32_t m_visibilitySlot; //bit of the threads' visibility masks, assigned by the pintool while the buffer is active
+		#endif
+
+		#if SHADOW_MEMORY_LOOKUP
+			ShadowMemory::Slot m_shadowSlot; //what the shadow memory holds for the pages of the buffer, assigned by the pintool while the buffer is active
+		#endif
+
+		#if ACCESS_HEATMAP
+			AccessHeatmap::BufferHeatmap m_heatmap;
+
+			void RecordHeatmapAccess(uint8_t const * const address, const size_t type, const size_t size /*in bytes*/) {
+				this->m_heatmap.RecordAccess(static_cast<size_t>(address - this->m_initialAddress), type, size);
+			}
+		#endif
+
+		void IncreaseAccess(const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts), const size_t type, const size_t size /*in bytes*/) {
+			#if INSTRUCTION_ATTRIBUTION
+				InstructionAttribution::RecordAccess(isThreadInjectionEnabled IF_PIN_LOCKED(&& isBufferInThread), type, size); //buffers of other threads are never injected, so their accesses are counted as precise
+			#endif
+
+			#if THREAD_PRIVATE_ACCESS_COUNTING
+				if (threadCounts != nullptr) {
+					threadCounts->m_accessedBytesCount[isThreadInjectionEnabled][type] += size; //only given for buffers in the thread
+					return;
+				}
+			#endif
+
+			this->m_periodLog.IncreaseAccess(isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread), type, size);
+		}
+
+		#if LOG_FAULTS
+			//errors of the accesses themselves (read and write), counted in the thread's shadow when there is one
+			uint64_t* GetAccessErrorCountsByBit(const size_t errorCat IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) const {
+				#if THREAD_PRIVATE_ACCESS_COUNTING
+					if (threadCounts != nullptr) {
+						return threadCounts->GetErrorCountsByBit(errorCat);
+					}
+				#endif
+
+				return this->m_periodLog.GetErrorCountsByBit(errorCat);
+			}
+		#endif
+
 		#if ENABLE_PASSIVE_INJECTION
 			#if !DISTANCE_BASED_FAULT_INJECTOR
 				std::unique_ptr<uint64_t[]> m_lastAccessPeriod;
@@ -93,9 +148,14 @@ class ApproximateBuffer : public Range {
 			void ApplyPassiveFault(uint8_t * const accessedAddress);
 			void ApplyAllPassiveErrors();
 
+			#if !DISTANCE_BASED_FAULT_INJECTOR && !OVERCHARGE_BER
+				void ApplyPassiveFaultRun(const size_t firstElementIndex, const size_t elementCount, uint8_t * const initialAddress);
+			#endif
+
 			#if LOG_FAULTS
 				uint64_t* GetPassiveErrorsLogFromIterator(const BufferLogs::const_iterator& it) const;
-				void AdvanceBufferLogIterator(BufferLogs::const_iterator& it) const;
+				BufferLogs::const_iterator FindBufferLog(const uint64_t period) const;
+				void AdvanceBufferLogIterator(BufferLogs::const_iterator& it, const uint64_t period) const;
 			#endif
 		#endif
 
@@ -103,8 +163,21 @@ class ApproximateBuffer : public Range {
 		virtual void GiveAwayRecordsAndBackups(const bool giveAway);
 
 		void StoreCurrentPeriodLog();
+
+		#if LAZY_PERIOD_ADVANCEMENT
+			void StoreIdlePeriodLogs(const uint64_t firstPeriod, const uint64_t endPeriod);
+			void StoreIdlePeriodLog(const uint64_t period, const uint64_t periodCount);
+		#endif
+
+		#if LIVE_STATISTICS && LOG_FAULTS
+			void AddPeriodErrorsToLiveStatistics(const PeriodLog& periodLog, const double sign) const;
+		#endif
 		void CleanLogs();
 
+		#if INJECTION_CONTEXT
+			void SetInjectionContext(const size_t errorCat, const uint64_t period);
+		#endif
+
 		uint64_t GetCurrentPassiveBerMarker() const;
 		bool GetShouldInject(const size_t errorCat, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) const;
 
@@ -119,8 +192,14 @@ class ApproximateBuffer : public Range {
 		bool IsMisaligned(uint8_t const * const address) const; 
 		size_t GetAlignmentOffset(uint8_t const * const address) const;
 
-		virtual void HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
-		virtual void HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
+		#if RANGE_ACCESS_HANDLING
+			bool GetWholeElementsWithin(uint8_t * const initialAddress, uint8_t const * const finalAddress, uint8_t*& firstElement, uint8_t const *& endElement) const;
+		#endif
+
+		static const size_t NO_DATA_SIZE_SHIFT = SIZE_MAX;
+
+		virtual void HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
+		virtual void HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
 
 	public:
 		ApproximateBuffer(const Range& bufferRange, const int64_t id, const uint64_t creationPeriod, const size_t dataSizeInBytes,
@@ -134,20 +213,66 @@ class ApproximateBuffer : public Range {
 		virtual void BackupReadData(uint8_t* const data) = 0;
 
 		void NextPeriod(const uint64_t period);
+
+		#if LAZY_PERIOD_ADVANCEMENT
+			//next_period() only moves g_currentPeriod, so an active buffer is brought up to it on its next access (or at its retirement)
+			void CatchUpPeriod() {
+				if (this->m_periodLog.m_period != g_currentPeriod && this->m_isActive > 0) {
+					this->NextPeriod(g_currentPeriod);
+				}
+			}
+		#endif
 		virtual void ReactivateBuffer(const uint64_t creationPeriod);
 		virtual bool RetireBuffer(const bool giveAwayRecords) = 0; //return true if it's retired
-		virtual void HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
-		virtual void HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
-		virtual void HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
-		virtual void HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
-		virtual void HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
-		virtual void HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread)) = 0;
+		virtual void HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
+		virtual void HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
+		virtual void HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
+		virtual void HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
+		virtual void HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
+		virtual void HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) = 0;
+
+		#if RANGE_ACCESS_HANDLING
+			void HandleMemoryReadRange(uint8_t * const initialAddress, uint8_t const * const finalAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+			void HandleMemoryWriteRange(uint8_t * const initialAddress, uint8_t const * const finalAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		#endif
 		
+		#if PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS
+			static const uint32_t NO_VISIBILITY_SLOT = UINT32_MAX;
+
+			uint32_t GetVisibilitySlot() const {
+				return this->m_visibilitySlot;
+			}
+
+			void SetVisibilitySlot(const uint32_t slot) {
+				this->m_visibilitySlot = slot;
+			}
+		#endif
+
+		#if THREAD_PRIVATE_ACCESS_COUNTING
+			ThreadAccessCounts& GetThreadAccessCounts(const THREADID threadId);
+		#endif
+
+		#if SHADOW_MEMORY_LOOKUP
+			ShadowMemory::Slot GetShadowSlot() const {
+				return this->m_shadowSlot;
+			}
+
+			void SetShadowSlot(const ShadowMemory::Slot slot) {
+				this->m_shadowSlot = slot;
+			}
+		#endif
+
 		int64_t GetConfigurationId() const;
 
-		void WriteLogHeaderToFile(std::ofstream& outputLog, const std::string& basePadding = "") const;
-		void WriteAccessLogToFile(std::ofstream& outputLog, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size>& totalTargetAccessesBytes, std::array<uint64_t, ErrorCategory::Size>& totalTargetInjections, const std::string& basePadding = "") const;
-		void WriteEnergyLogToFile(std::ofstream& outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& totalTargetEnergy, const ConsumptionProfile& respectiveConsumptionProfile, const std::string& basePadding = "") const;
+		void WriteLogHeaderToFile(std::ostream& outputLog, const std::string& basePadding = "") const;
+		void WriteAccessLogToFile(std::ostream& outputLog, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size>& totalTargetAccessesBytes, std::array<ErrorCount, ErrorCategory::Size>& totalTargetInjections IF_COMMA_PERIOD_SAMPLING(SampledBytes& totalTargetSampledBytes), const std::string& basePadding = "") const;
+		void WriteEnergyLogToFile(std::ostream& outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& totalTargetEnergy, const ConsumptionProfile& respectiveConsumptionProfile, const std::string& basePadding = "") const;
+
+		#if ACCESS_HEATMAP
+			void WriteHeatmapToFile(std::ofstream& outputLog) const {
+				this->m_heatmap.WriteToFile(outputLog, this->m_id);
+			}
+		#endif
 };
 
 /* ==================================================================== */
@@ -159,21 +284,13 @@ typedef std::map<uint8_t* const, uint8_t*> RemainingReads;
 #if MULTIPLE_BER_CONFIGURATION
 	#if LOG_FAULTS
 		#if !DISTANCE_BASED_FAULT_INJECTOR
-			#if MULTIPLE_BER_ELEMENT
-				typedef std::map<uint8_t* const, std::pair<double const *, uint64_t*>>				PendingWrites;
-			#else
-				typedef std::map<uint8_t* const, std::pair<double, uint64_t*>>						PendingWrites;
-			#endif
+			typedef std::map<uint8_t* const, std::pair<InjectionBer, uint64_t*>>					PendingWrites;
 		#else
 			typedef std::map<uint8_t* const, std::pair<DistanceBasedInjectorRecord*, uint64_t*>>	PendingWrites;
 		#endif
 	#else
 		#if !DISTANCE_BASED_FAULT_INJECTOR
-			#if MULTIPLE_BER_ELEMENT
-				typedef std::map<uint8_t* const, double const *>									PendingWrites;
-			#else
-				typedef std::map<uint8_t* const, double>											PendingWrites;
-			#endif
+			typedef std::map<uint8_t* const, InjectionBer>											PendingWrites;
 		#else
 			typedef std::map<uint8_t* const, DistanceBasedInjectorRecord*>							PendingWrites;
 		#endif
@@ -186,7 +303,7 @@ typedef std::map<uint8_t* const, uint8_t*> RemainingReads;
 	#endif
 #endif
 
-class ShortTermApproximateBuffer : virtual public ApproximateBuffer {
+class ShortTermApproximateBuffer final : public ApproximateBuffer {
 	protected: 
 		PendingWrites m_pendingWrites;
 		RemainingReads m_remainingReads;
@@ -196,7 +313,7 @@ class ShortTermApproximateBuffer : virtual public ApproximateBuffer {
 		void ApplyFaultyWrite(uint8_t * const accessedAddress);
 		void ApplyFaultyWrite(uint8_t * const initialAddress, uint8_t const * const finalAddress);
 		void ApplyAllWriteErrors();
-		void RecordFaultyWrite(uint8_t* const address, PendingWrites::const_iterator& hint);
+		void RecordFaultyWrite(uint8_t* const address, PendingWrites::const_iterator& hint IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
 		RemainingReads::const_iterator ReverseFaultyRead(const RemainingReads::const_iterator it);
 		RemainingReads::const_iterator ReverseFaultyRead(uint8_t * const accessedAddess);
 		RemainingReads::const_iterator ReverseFaultyRead(uint8_t * const initialAddress, uint8_t const * const finalAddress);
@@ -212,8 +329,8 @@ class ShortTermApproximateBuffer : virtual public ApproximateBuffer {
 			static uint64_t* GetWriteErrorsLogFromIterator(const PendingWrites::const_iterator& it);
 		#endif
 
-		virtual void HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
+		virtual void HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
 	
 	public:
 		ShortTermApproximateBuffer(const Range& bufferRange, const int64_t id, const uint64_t creationPeriod, const size_t dataSizeInBytes,
@@ -223,12 +340,12 @@ class ShortTermApproximateBuffer : virtual public ApproximateBuffer {
 		virtual void BackupReadData(uint8_t* const data);
 		virtual void ReactivateBuffer(const uint64_t creationPeriod);
 		virtual bool RetireBuffer(const bool giveAwayRecords);
-		virtual void HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
+		virtual void HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
 };
 
 /* ==================================================================== */
@@ -255,11 +372,7 @@ class InjectionRecord {
 		public:
 			#if MULTIPLE_BER_CONFIGURATION
 				#if !DISTANCE_BASED_FAULT_INJECTOR
-					#if MULTIPLE_BER_ELEMENT
-						double const * writeSupport;
-					#else
-						double writeSupport;
-					#endif
+					InjectionBer writeSupport;
 				#else
 					DistanceBasedInjectorRecord* writeSupport;
 				#endif
@@ -291,7 +404,7 @@ namespace BorrowedMemory {
 	#endif
 }
 
-class LongTermApproximateBuffer : virtual public ApproximateBuffer {
+class LongTermApproximateBuffer final : public ApproximateBuffer {
 	protected: 
 		std::unique_ptr<InjectionRecord[]> m_records;
 		std::unique_ptr<uint8_t[]> m_readBackups;
@@ -309,15 +422,16 @@ class LongTermApproximateBuffer : virtual public ApproximateBuffer {
 		void ApplyWriteFault(const size_t elementIndex, uint8_t* const accessedAddress);
 		void ReverseFaultyRead(const size_t elementIndex, uint8_t* const accessedAddress);
 
-		void RecordFaultyWrite(const size_t elementIndex);
+		void RecordFaultyWrite(const size_t elementIndex IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
 
 		auto GetWriteBer(const size_t elementIndex);
 
-		void ProcessWrittenMemoryElement(const size_t elementIndex, const uint8_t newStatus, const bool shouldInject);
-		void ProcessReadMemoryElement(const size_t elementIndex, uint8_t* const accessedAddress, const bool shouldInject);
+		void ProcessWrittenMemoryElement(const size_t elementIndex, const uint8_t newStatus, const bool shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		void RestoreMemoryElement(const size_t elementIndex, uint8_t* const accessedAddress); //reverses its read fault or applies its write fault
+		void ProcessReadMemoryElement(const size_t elementIndex, uint8_t* const accessedAddress, const bool shouldInject IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
 
-		virtual void HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
+		virtual void HandleMemoryReadSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryWriteSingleElementUnsafe(uint8_t * const accessedAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
 
 	public:
 		LongTermApproximateBuffer(const Range& bufferRange, const int64_t id, const uint64_t creationPeriod, const size_t dataSizeInBytes,
@@ -333,12 +447,19 @@ class LongTermApproximateBuffer : virtual public ApproximateBuffer {
 
 		virtual void ReactivateBuffer(const uint64_t creationPeriod);
 		virtual bool RetireBuffer(const bool giveAwayRecords);
-		virtual void HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
-		virtual void HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread));
+		virtual void HandleMemoryReadSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryWriteSIMD(uint8_t * const initialAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryReadSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryWriteSingleElementSafe(uint8_t * const accessedAddress, const uint32_t accessSize, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryReadScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
+		virtual void HandleMemoryWriteScattered(IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts));
 };
 
+//every buffer of a run is of this (final) type, so calls made through it are direct instead of virtual
+#if LONG_TERM_BUFFER
+	typedef LongTermApproximateBuffer ChosenTermApproximateBuffer;
+#else
+	typedef ShortTermApproximateBuffer ChosenTermApproximateBuffer;
+#endif
+
 #endif /* APPROXIMATE_BUFFER_H */
\ No newline at end of file
@@ -10,12 +10,26 @@
 #include <fstream>
 #include <algorithm>
 #include <unistd.h>
+#include <sys/resource.h>
 #include <iomanip>
 #include <ctime>
 #include <sstream>
+#include <random>
+#include <unordered_set>
+#include <vector>
+#include <atomic>
 #include "approximate-buffer.h"
 #include "configuration-input.h"
 #include "compiling-options.h"
+#include "self-profiler.h"
+#include "live-statistics.h"
+#include "instrumentation-filter.h"
+#include "shadow-memory.h"
+#include "fault-trace.h"
+#include "instruction-attribution.h"
+#include "log-writer.h"
+#include "persistent-counters.h"
+#include "../instrumentation_dummies/approx.h"
 
 //bool g_isGlobalInjectionEnabled = true;
 //int g_level = 0;
@@ -23,9 +37,16 @@ uint64_t g_injectionCalls 	= 0; //NOTE: possible race condition, but I don't car
 
 uint64_t g_currentPeriod 	= 0; //NOTE: possible minor race condition, but 99.9999% inconsequential and also actually impossible in current lock implementation
 
+#if PERIOD_SAMPLING
+	bool g_isSampledPeriod 	= true; //the first period is always sampled
+#endif
+
 #if PIN_LOCKED
 	PIN_LOCK g_pinLock;
-	TLS_KEY g_tlsKey = INVALID_TLS_KEY;
+	REG g_threadControlReg = REG_INVALID(); //tool register holding the ThreadControl* of each thread, set at its start and passed directly to the analysis routines
+	#define IARG_THREAD_CONTROL IARG_REG_VALUE, g_threadControlReg,
+#else
+	#define IARG_THREAD_CONTROL
 #endif
 
 #if NARROW_ACCESS_INSTRUMENTATION
@@ -39,12 +60,6 @@ uint64_t g_currentPeriod 	= 0; //NOTE: possible minor race condition, but 99.999
 
 ///////////////////////////////////////////////////////
 
-#if LONG_TERM_BUFFER
-	typedef LongTermApproximateBuffer ChosenTermApproximateBuffer;
-#else
-	typedef ShortTermApproximateBuffer ChosenTermApproximateBuffer;
-#endif
-
 typedef std::tuple<uint8_t const *, uint8_t const *, int64_t, int64_t, size_t> GeneralBufferRecord; //<Range, BufferId, ConfigurationId, dataSizeInBytes>
 typedef std::map<GeneralBufferRecord, const std::unique_ptr<ChosenTermApproximateBuffer>> GeneralBuffers; 
 
@@ -70,10 +85,26 @@ class ThreadControl {
 			ChosenTermApproximateBuffer* m_activeBuffer;
 		#endif
 
+		#if PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS
+			uint64_t m_visibleSlots; //buffers (by visibility slot) added by this thread
+		#endif
+
+		#if THREAD_PRIVATE_ACCESS_COUNTING
+			mutable std::array<ThreadAccessCounts*, 64> m_accessCounts; //this thread's counters of each buffer (by visibility slot), looked up on the first access
+		#endif
+
 	ThreadControl(const THREADID threadId) : m_threadId(threadId) {
 		this->m_level = 0;
 		this->m_injectionEnabled = true;
 
+		#if PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS
+			this->m_visibleSlots = 0;
+		#endif
+
+		#if THREAD_PRIVATE_ACCESS_COUNTING
+			this->m_accessCounts.fill(nullptr);
+		#endif
+
 		#if MULTIPLE_ACTIVE_BUFFERS
 			//this->m_activeBuffers();
 		#else
@@ -86,6 +117,10 @@ class ThreadControl {
 	}
 
 	~ThreadControl() {
+		this->RetireActiveBuffers();
+	}
+
+	void RetireActiveBuffers() {
 		#if MULTIPLE_ACTIVE_BUFFERS
 			for (ActiveBuffers::const_iterator it = this->m_activeBuffers.cbegin(); it != this->m_activeBuffers.cend(); ) { 
 				ChosenTermApproximateBuffer& approxBuffer = *(it->second);
@@ -110,6 +145,14 @@ class ThreadControl {
 		;
 	}
 
+	uint64_t GetActiveBufferCount() const {
+		#if MULTIPLE_ACTIVE_BUFFERS
+			return this->m_activeBuffers.size();
+		#else
+			return (this->m_activeBuffer != nullptr);
+		#endif
+	}
+
 	bool IsPresent(const Range& range) const {
 		#if MULTIPLE_ACTIVE_BUFFERS
 			const ActiveBuffers::const_iterator it =  this->m_activeBuffers.find(range);
@@ -135,18 +178,332 @@ typedef std::map<THREADID, std::unique_ptr<ThreadControl>> ThreadControlMap;
 InjectorConfigurationMap	g_injectorConfigurations; //todo: place them into the PintoolControl namespace eventually
 ConsumptionProfileMap 		g_consumptionProfiles;
 
+#if ADAPTIVE_INSTRUMENTATION
+	namespace AdaptiveInstrumentation {
+		//analysis calls update the profiles and counters from any thread, outside of g_pinLock, so they are atomic (relaxed: only the pruning decision depends on them)
+		class InstructionProfile {
+			public:
+				std::atomic<uint64_t> m_executions{0};
+				std::atomic<uint64_t> m_hits{0};
+				std::atomic<uint64_t> m_generation{0};
+				std::atomic<bool> m_isPruned{false};
+		};
+
+		uint64_t warmUpExecutions					= 10000;
+		std::atomic<uint64_t> generation{0};			//advanced by every restoration, older prunings are discarded
+		std::atomic<uint64_t> prunedInstructions{0};	//in the current generation
+		std::atomic<uint64_t> totalPrunings{0};
+		uint64_t restorations						= 0;
+
+		//by instruction address, nodes are never moved (analysis calls keep pointers to them)
+		//only accessed at instrumentation time, which is serialized by Pin
+		std::unordered_map<ADDRINT, InstructionProfile> profiles;
+
+		//returns nullptr if the instruction was pruned and should not be instrumented
+		//a profile of an older generation is reset for the current one. stale code cache copies may still count a few executions into it, which are real executions of the instruction anyway
+		InstructionProfile* GetProfile(const INS ins) {
+			InstructionProfile& profile = AdaptiveInstrumentation::profiles[INS_Address(ins)];
+			const uint64_t currentGeneration = AdaptiveInstrumentation::generation.load(std::memory_order_relaxed);
+
+			if (profile.m_generation.load(std::memory_order_relaxed) != currentGeneration) {
+				profile.m_executions.store(0, std::memory_order_relaxed);
+				profile.m_hits.store(0, std::memory_order_relaxed);
+				profile.m_isPruned.store(false, std::memory_order_relaxed);
+				profile.m_generation.store(currentGeneration, std::memory_order_relaxed);
+			}
+
+			return profile.m_isPruned.load(std::memory_order_relaxed) ? nullptr : &profile;
+		}
+
+		//needs no lock: only the thread whose execution reaches the warm-up count (and then wins the pruned flag) prunes the instruction
+		inline void RecordExecution(InstructionProfile * const profile, const ADDRINT instructionAddress, const bool isHit) {
+			const uint64_t executions = profile->m_executions.fetch_add(1, std::memory_order_relaxed) + 1;
+
+			if (isHit) {
+				profile->m_hits.fetch_add(1, std::memory_order_relaxed);
+			} else if (executions == AdaptiveInstrumentation::warmUpExecutions && profile->m_hits.load(std::memory_order_relaxed) == 0 
+						&& profile->m_generation.load(std::memory_order_relaxed) == AdaptiveInstrumentation::generation.load(std::memory_order_relaxed)
+						&& !profile->m_isPruned.exchange(true, std::memory_order_relaxed)) {
+				AdaptiveInstrumentation::prunedInstructions.fetch_add(1, std::memory_order_relaxed);
+				AdaptiveInstrumentation::totalPrunings.fetch_add(1, std::memory_order_relaxed);
+
+				//the code cache copy of this instruction is discarded, GetProfile prevents the new copy from being instrumented
+				PIN_RemoveInstrumentationInRange(instructionAddress, instructionAddress);
+			}
+		}
+
+		//MUST LOCK
+		//a new approximate range may be accessed by pruned instructions, so every instruction is instrumented again
+		void RestoreInstrumentation() {
+			if (AdaptiveInstrumentation::prunedInstructions.exchange(0, std::memory_order_relaxed) == 0) {
+				return;
+			}
+
+			AdaptiveInstrumentation::generation.fetch_add(1, std::memory_order_relaxed);
+			++AdaptiveInstrumentation::restorations;
+
+			PIN_RemoveInstrumentation();
+		}
+
+		void ConfigureWarmUp(const uint64_t executions) {
+			if (executions == 0) {
+				std::cerr << "ApproxSS Error: the adaptive instrumentation warm-up must be greater than 0." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			AdaptiveInstrumentation::warmUpExecutions = executions;
+		}
+
+		void PrintSummary() {
+			std::cout << "ApproxSS: adaptive instrumentation pruned " << AdaptiveInstrumentation::totalPrunings << " instruction(s) and restored full instrumentation " << AdaptiveInstrumentation::restorations << " time(s)." << std::endl;
+		}
+	}
+#endif
+
 namespace PintoolControl {
 	GeneralBuffers generalBuffers;
 	ThreadControl g_mainThreadControl(-1);
 
 	#if PIN_LOCKED 
 		ThreadControlMap threadControlMap;	
+		static PIN_LOCK tcMap_lock;
+	#endif
+
+	#if PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS
+		//each active buffer takes a bit of the threads' visibility masks, so that the buffer lookup already tells if it was added by the accessing thread
+		//buffers beyond the 64 slots fall back to a lookup in the thread's own active buffers
+		uint64_t usedVisibilitySlots = 0;
+
+		//MUST LOCK
+		void AcquireVisibilitySlot(ChosenTermApproximateBuffer& approxBuffer) {
+			if (PintoolControl::usedVisibilitySlots == UINT64_MAX) {
+				approxBuffer.SetVisibilitySlot(ApproximateBuffer::NO_VISIBILITY_SLOT);
+				return;
+			}
+
+			const uint32_t slot = static_cast<uint32_t>(__builtin_ctzll(~PintoolControl::usedVisibilitySlots));
+			PintoolControl::usedVisibilitySlots |= (1ull << slot);
+			approxBuffer.SetVisibilitySlot(slot);
+		}
+
+		//MUST LOCK
+		//only once the buffer left the main thread's active buffers. the bit is cleared in every thread, as the buffer may still be in the active buffers of threads other than the one removing it, and the slot is about to be reused
+		void ReleaseVisibilitySlot(ChosenTermApproximateBuffer& approxBuffer) {
+			const uint32_t slot = approxBuffer.GetVisibilitySlot();
+			if (slot != ApproximateBuffer::NO_VISIBILITY_SLOT) {
+				const uint64_t slotMask = ~(1ull << slot);
+
+				PIN_GetLock(&tcMap_lock, -1);
+				for (const auto& [_, threadControl] : PintoolControl::threadControlMap) {
+					threadControl->m_visibleSlots &= slotMask;
+					IF_THREAD_PRIVATE_ACCESS_COUNTING(threadControl->m_accessCounts[slot] = nullptr;)
+				}
+				PIN_ReleaseLock(&tcMap_lock);
+
+				PintoolControl::usedVisibilitySlots &= slotMask;
+				approxBuffer.SetVisibilitySlot(ApproximateBuffer::NO_VISIBILITY_SLOT);
+			}
+		}
+
+		void SetVisibility(ThreadControl& threadControl, ChosenTermApproximateBuffer const & approxBuffer, const bool isVisible) {
+			const uint32_t slot = approxBuffer.GetVisibilitySlot();
+			if (slot == ApproximateBuffer::NO_VISIBILITY_SLOT) {
+				return;
+			}
+
+			if (isVisible) {
+				threadControl.m_visibleSlots |= (1ull << slot);
+			} else {
+				threadControl.m_visibleSlots &= ~(1ull << slot);
+			}
+		}
+	#endif
+
+	#if SHADOW_MEMORY_LOOKUP
+		std::array<ChosenTermApproximateBuffer*, ShadowMemory::SLOT_COUNT> shadowSlotBuffers{};
+		std::vector<ShadowMemory::Slot> freeShadowSlots;
+		ShadowMemory::Slot nextShadowSlot = ShadowMemory::FIRST_SLOT;
+
+		//MUST LOCK
+		//a page may be shared with the neighbouring buffers, so its slot is worked out from the active buffers themselves
+		ShadowMemory::Slot GetPageSlot(const ActiveBuffers& activeBuffers, const size_t page) {
+			uint8_t* const pageStart = reinterpret_cast<uint8_t*>(page << ShadowMemory::PAGE_SHIFT);
+			const Range pageRange = Range(pageStart, pageStart + (1ull << ShadowMemory::PAGE_SHIFT));
+
+			ActiveBuffers::const_iterator it = activeBuffers.lower_bound(pageRange);
+			if (it == activeBuffers.cend() || !it->first.DoesIntersectWith(pageRange)) {
+				return ShadowMemory::NO_BUFFER;
+			}
+
+			const ShadowMemory::Slot slot = it->second->GetShadowSlot();
+
+			++it;
+			if (it != activeBuffers.cend() && it->first.DoesIntersectWith(pageRange)) {
+				return ShadowMemory::SHARED_PAGE;
+			}
+
+			return slot;
+		}
+
+		//MUST LOCK
+		//pages fully inside the range get interiorSlot, the (possibly shared) edge pages are recomputed
+		void UpdateShadowPages(const ActiveBuffers& activeBuffers, const Range& range, const ShadowMemory::Slot interiorSlot) {
+			const size_t firstPage = ShadowMemory::GetPage(range.m_initialAddress);
+			if (firstPage >= ShadowMemory::PAGE_COUNT) {
+				return;
+			}
+
+			const size_t lastPage = std::min(ShadowMemory::GetPage(range.m_finalAddress - 1), ShadowMemory::PAGE_COUNT - 1);
+
+			ShadowMemory::SetPages(firstPage + 1, lastPage, interiorSlot);
+			ShadowMemory::g_pageSlots[firstPage] = PintoolControl::GetPageSlot(activeBuffers, firstPage);
+			ShadowMemory::g_pageSlots[lastPage] = PintoolControl::GetPageSlot(activeBuffers, lastPage);
+		}
+
+		//MUST LOCK
+		//after the buffer is in the main thread's active buffers. past the last slot, its pages are left to the regular lookup
+		void AddToShadowMemory(const ActiveBuffers& activeBuffers, ChosenTermApproximateBuffer& approxBuffer) {
+			ShadowMemory::Slot slot = ShadowMemory::SHARED_PAGE;
+
+			if (!PintoolControl::freeShadowSlots.empty()) {
+				slot = PintoolControl::freeShadowSlots.back();
+				PintoolControl::freeShadowSlots.pop_back();
+			} else if (PintoolControl::nextShadowSlot < ShadowMemory::SLOT_COUNT) {
+				slot = PintoolControl::nextShadowSlot++;
+			}
+
+			if (slot != ShadowMemory::SHARED_PAGE) {
+				PintoolControl::shadowSlotBuffers[slot] = &approxBuffer;
+			}
+
+			approxBuffer.SetShadowSlot(slot);
+			PintoolControl::UpdateShadowPages(activeBuffers, approxBuffer, slot);
+		}
+
+		//MUST LOCK
+		//after the buffer is out of the main thread's active buffers
+		void RemoveFromShadowMemory(const ActiveBuffers& activeBuffers, ChosenTermApproximateBuffer& approxBuffer) {
+			const ShadowMemory::Slot slot = approxBuffer.GetShadowSlot();
+
+			if (slot != ShadowMemory::SHARED_PAGE) {
+				PintoolControl::shadowSlotBuffers[slot] = nullptr;
+				PintoolControl::freeShadowSlots.push_back(slot);
+			}
+
+			approxBuffer.SetShadowSlot(ShadowMemory::SHARED_PAGE);
+			PintoolControl::UpdateShadowPages(activeBuffers, approxBuffer, ShadowMemory::NO_BUFFER);
+		}
+	#endif
+
+	#if PERIOD_SAMPLING
+		uint64_t samplingInterval	= 1;
+		double samplingRate			= 1.0;
+		std::default_random_engine samplingGenerator{std::random_device{}()};
+		std::uniform_real_distribution<double> samplingDistribution(0.0, 1.0);
+
+		void ConfigurePeriodSampling(const uint64_t interval, const double rate) {
+			if (interval == 0) {
+				std::cerr << "ApproxSS Error: the period sampling interval must be greater than 0." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			if (!(rate > 0.0 && rate <= 1.0)) {
+				std::cerr << "ApproxSS Error: the period sampling rate must be in the (0, 1] interval." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			if (interval != 1 && rate != 1.0) {
+				std::cerr << "ApproxSS Error: systematic (interval) and random (rate) period sampling are mutually exclusive." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			PintoolControl::samplingInterval = interval;
+			PintoolControl::samplingRate = rate;
+		}
+
+		bool IsPeriodSampled(const uint64_t period) {
+			if (PintoolControl::samplingRate < 1.0) {
+				return PintoolControl::samplingDistribution(PintoolControl::samplingGenerator) < PintoolControl::samplingRate;
+			}
+
+			return (period % PintoolControl::samplingInterval) == 0;
+		}
+	#endif
+
+	#if STACK_ACCESS_ELISION
+		constexpr ADDRINT STACK_RED_ZONE = 128;
+
+		bool isStackInstrumentationEnabled	= false; //once enabled, never disabled
+		ADDRINT stackSizeLimit				= 8 * 1024 * 1024;
+
+		std::map<THREADID, ADDRINT> threadStackTops; //stack pointer of each live thread at its start, its stack is assumed to span the stack size limit below it
+		PIN_LOCK threadStacks_lock;
+
+		void ConfigureStackAccessElision() {
+			struct rlimit stackLimit;
+			if (getrlimit(RLIMIT_STACK, &stackLimit) == 0 && stackLimit.rlim_cur != RLIM_INFINITY) {
+				PintoolControl::stackSizeLimit = static_cast<ADDRINT>(stackLimit.rlim_cur);
+			}
+		}
+
+		//registered on its own, as without PIN_LOCKED there is no ThreadStart, but a buffer may still be on the stack of another thread
+		VOID RecordThreadStack(const THREADID threadId, CONTEXT * ctxt, const INT32 flags, VOID * v) {
+			const ADDRINT stackTop = PIN_GetContextReg(ctxt, REG_STACK_PTR);
+
+			PIN_GetLock(&PintoolControl::threadStacks_lock, threadId);
+			PintoolControl::threadStackTops[threadId] = stackTop;
+			PIN_ReleaseLock(&PintoolControl::threadStacks_lock);
+		}
+
+		VOID ForgetThreadStack(const THREADID threadId, CONTEXT const * const ctxt, const INT32 code, VOID * v) {
+			PIN_GetLock(&PintoolControl::threadStacks_lock, threadId);
+			PintoolControl::threadStackTops.erase(threadId);
+			PIN_ReleaseLock(&PintoolControl::threadStacks_lock);
+		}
+
+		static bool IsOnStack(const ADDRINT initialAddress, const ADDRINT finalAddress, const ADDRINT stackLow, const ADDRINT stackHigh) {
+			return finalAddress > stackLow && initialAddress < stackHigh;
+		}
+
+		//MUST LOCK
+		//buffers are expected in the frames of the caller of add_approx, i.e., between its stack pointer and the stack size limit above it, or in the stack of any other live thread (e.g., a local array handed to the thread that adds it)
+		//a false positive (e.g., a mapping right above a thread stack) only costs performance. a thread stack larger than the stack size limit (pthread_attr_setstacksize) is only partially covered
+		void CheckStackResidentBuffer(const Range& range, const int64_t bufferId, const ADDRINT stackPointer) {
+			if (PintoolControl::isStackInstrumentationEnabled) {
+				return;
+			}
+
+			const ADDRINT initialAddress = reinterpret_cast<ADDRINT>(range.m_initialAddress);
+			const ADDRINT finalAddress = reinterpret_cast<ADDRINT>(range.m_finalAddress);
+
+			bool isOnStack = PintoolControl::IsOnStack(initialAddress, finalAddress, stackPointer - STACK_RED_ZONE, stackPointer + PintoolControl::stackSizeLimit);
+
+			if (!isOnStack) {
+				PIN_GetLock(&PintoolControl::threadStacks_lock, -1);
+				for (const auto& [_, stackTop] : PintoolControl::threadStackTops) {
+					const ADDRINT stackLow = (stackTop > PintoolControl::stackSizeLimit) ? (stackTop - PintoolControl::stackSizeLimit) : 0;
+					if (PintoolControl::IsOnStack(initialAddress, finalAddress, stackLow, stackTop)) {
+						isOnStack = true;
+						break;
+					}
+				}
+				PIN_ReleaseLock(&PintoolControl::threadStacks_lock);
+			}
+
+			if (isOnStack) {
+				PintoolControl::isStackInstrumentationEnabled = true;
+				std::cout << "ApproxSS Warning: approximate buffer (id: " << bufferId << ") is on the stack. Stack accesses will be instrumented from now on." << std::endl;
+
+				//already instrumented code skips stack accesses, so it must be instrumented again
+				PIN_RemoveInstrumentation();
+			}
+		}
 	#endif
 
 	//i had to add the next two because i needed a simple and direct way of enabling and disabling the error injection
-	VOID enable_global_injection(IF_PIN_LOCKED(const THREADID threadId)) {
+	VOID enable_global_injection(IF_PIN_LOCKED(ThreadControl * const threadControl)) {
 		#if PIN_LOCKED
-			ThreadControl& tdata = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId))); //TODO: they only really make sense for their thread 
+			ThreadControl& tdata = *threadControl; //TODO: they only really make sense for their thread 
 		#else
 			ThreadControl& tdata = PintoolControl::g_mainThreadControl;
 		#endif
@@ -154,9 +511,9 @@ namespace PintoolControl {
 		tdata.m_injectionEnabled = true;
 	}
 
-	VOID disable_global_injection(IF_PIN_LOCKED(const THREADID threadId)) {
+	VOID disable_global_injection(IF_PIN_LOCKED(ThreadControl * const threadControl)) {
 		#if PIN_LOCKED
-			ThreadControl& tdata = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId)));
+			ThreadControl& tdata = *threadControl;
 		#else
 			ThreadControl& tdata = PintoolControl::g_mainThreadControl;
 		#endif
@@ -169,9 +526,9 @@ namespace PintoolControl {
 	}
 
 	//effectively enables the error injection  //not a boolean to allow layers (so functions that call each other don't disable the injection)
-	VOID start_level(IF_PIN_LOCKED(const THREADID threadId)) {
+	VOID start_level(IF_PIN_LOCKED(ThreadControl * const threadControl)) {
 		#if PIN_LOCKED
-			ThreadControl& tdata = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId)));
+			ThreadControl& tdata = *threadControl;
 		#else
 			ThreadControl& tdata = PintoolControl::g_mainThreadControl;
 		#endif
@@ -180,9 +537,9 @@ namespace PintoolControl {
 	}
 
 	//effectively disables the error injection
-	VOID end_level(IF_PIN_LOCKED(const THREADID threadId)) {
+	VOID end_level(IF_PIN_LOCKED(ThreadControl * const threadControl)) {
 		#if PIN_LOCKED
-			ThreadControl& tdata = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId)));
+			ThreadControl& tdata = *threadControl;
 		#else
 			ThreadControl& tdata = PintoolControl::g_mainThreadControl;
 		#endif
@@ -193,32 +550,58 @@ namespace PintoolControl {
 	VOID next_period() {
 		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
 
+		PROFILE_SCOPE(NextPeriod)
+
 		++g_currentPeriod;
 
-		ThreadControl& tdata = PintoolControl::g_mainThreadControl;
+		#if PERIOD_SAMPLING
+			g_isSampledPeriod = PintoolControl::IsPeriodSampled(g_currentPeriod);
+		#endif
 
-		#if MULTIPLE_ACTIVE_BUFFERS
-			for (const auto& [_, activeBuffer] : tdata.m_activeBuffers) {
-				activeBuffer->NextPeriod(g_currentPeriod);
-			}
-		#else
-			if (tdata.m_activeBuffer != nullptr) {
-				tdata.m_activeBuffer->NextPeriod(g_currentPeriod);
-			}
+		#if !LAZY_PERIOD_ADVANCEMENT //otherwise, each active buffer catches up on its next access (or at its retirement)
+			ThreadControl& tdata = PintoolControl::g_mainThreadControl;
+
+			#if MULTIPLE_ACTIVE_BUFFERS
+				for (const auto& [_, activeBuffer] : tdata.m_activeBuffers) {
+					activeBuffer->NextPeriod(g_currentPeriod);
+				}
+			#else
+				if (tdata.m_activeBuffer != nullptr) {
+					tdata.m_activeBuffer->NextPeriod(g_currentPeriod);
+				}
+			#endif
 		#endif
 
 		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
 	}
 
-	VOID add_approx(IF_PIN_LOCKED_COMMA(const THREADID threadId) uint8_t * const start_address, uint8_t const * const end_address, const int64_t bufferId, const int64_t configurationId, const uint32_t dataSizeInBytes) {
-		const Range range = Range(start_address, end_address);
-		
+	#if MULTIPLE_ACTIVE_BUFFERS
+		//lower_bound for ranges added in ascending order of initial address: every buffer before the hint must lie before the range (true for the lower bound of the previous range)
+		//the hint and its successor are checked before falling back to a search of the whole tree
+		ActiveBuffers::const_iterator LowerBoundFrom(const ActiveBuffers& activeBuffers, ActiveBuffers::const_iterator hint, const Range& range) {
+			if (hint != activeBuffers.cend() && activeBuffers.key_comp()(hint->first, range)) {
+				++hint;
+			}
+
+			if (hint == activeBuffers.cend() || !activeBuffers.key_comp()(hint->first, range)) {
+				return hint;
+			}
+
+			return activeBuffers.lower_bound(range);
+		}
+	#endif
+
+	//MUST LOCK
+	//lbActiveMain (MULTIPLE_ACTIVE_BUFFERS): hint for the main thread's active buffers (see LowerBoundFrom), left at the added (or overlapping) buffer
+	void AddBuffer(IF_PIN_LOCKED_COMMA(ThreadControl& localThread) const Range& range, const int64_t bufferId, const int64_t configurationId, const uint32_t dataSizeInBytes IF_COMMA_STACK_ACCESS_ELISION(const ADDRINT stackPointer) IF_COMMA_MULTIPLE_ACTIVE_BUFFERS(ActiveBuffers::const_iterator& lbActiveMain)) {
 		ThreadControl& mainThread = PintoolControl::g_mainThreadControl;
 
-		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+		#if STACK_ACCESS_ELISION
+			PintoolControl::CheckStackResidentBuffer(range, bufferId, stackPointer);
+		#endif
 
 		#if MULTIPLE_ACTIVE_BUFFERS
-			ActiveBuffers::const_iterator lbActiveMain = mainThread.m_activeBuffers.lower_bound(range);
+			lbActiveMain = PintoolControl::LowerBoundFrom(mainThread.m_activeBuffers, lbActiveMain, range);
 			if (!((lbActiveMain != mainThread.m_activeBuffers.cend()) && !(mainThread.m_activeBuffers.key_comp()(range, lbActiveMain->first)))) //only inserts if it wasn't found (done like this to avoid possible memory leaks from the new's in case there's a overlap)
 		#else
 			if (mainThread.m_activeBuffer == nullptr)
@@ -232,6 +615,10 @@ namespace PintoolControl {
 					ChosenTermApproximateBuffer* const approxBuffer = lbGeneral->second.get();
 					approxBuffer->ReactivateBuffer(g_currentPeriod);
 					lbActiveMain = mainThread.m_activeBuffers.insert(lbActiveMain, {range, approxBuffer});
+					IF_PIN_LOCKED(PintoolControl::AcquireVisibilitySlot(*approxBuffer);)
+					#if SHADOW_MEMORY_LOOKUP
+						PintoolControl::AddToShadowMemory(mainThread.m_activeBuffers, *approxBuffer);
+					#endif
 				#else
 					mainThread.m_activeBuffer = lbGeneral->second.get();
 					mainThread.m_activeBuffer->ReactivateBuffer(g_currentPeriod);
@@ -248,6 +635,10 @@ namespace PintoolControl {
 
 				#if MULTIPLE_ACTIVE_BUFFERS
 					lbActiveMain = mainThread.m_activeBuffers.insert(lbActiveMain, {range, approxBuffer});
+					IF_PIN_LOCKED(PintoolControl::AcquireVisibilitySlot(*approxBuffer);)
+					#if SHADOW_MEMORY_LOOKUP
+						PintoolControl::AddToShadowMemory(mainThread.m_activeBuffers, *approxBuffer);
+					#endif
 				#else
 					mainThread.m_activeBuffer = approxBuffer;
 				#endif
@@ -262,15 +653,14 @@ namespace PintoolControl {
 		#endif
 
 		{
-			#if PIN_LOCKED 
-				ThreadControl& localThread = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId)));
-
+			#if PIN_LOCKED
 				#if MULTIPLE_ACTIVE_BUFFERS
 					const ActiveBuffers::const_iterator lbActiveLocal = localThread.m_activeBuffers.lower_bound(range);
 					if (!((lbActiveLocal != localThread.m_activeBuffers.cend()) && !(localThread.m_activeBuffers.key_comp()(range, lbActiveLocal->first)))) { //only inserts if it wasn't found (done like this to avoid possible memory leaks from the new's in case there's a overlap)
 						ChosenTermApproximateBuffer* const approxBuffer = lbActiveMain->second;
 						approxBuffer->ReactivateBuffer(g_currentPeriod);
 						localThread.m_activeBuffers.insert(lbActiveLocal, {range, approxBuffer});
+						PintoolControl::SetVisibility(localThread, *approxBuffer, true);
 					}
 				#else
 					if (localThread.m_activeBuffer == nullptr) {
@@ -279,28 +669,46 @@ namespace PintoolControl {
 					}
 				#endif
 				  else {
-					std::cout << "ApproxSS Warning: approximate buffer (id: " << bufferId << ") already active in thread " << threadId << ". Ignoring addition request." << std::endl;
+					std::cout << "ApproxSS Warning: approximate buffer (id: " << bufferId << ") already active in thread " << localThread.m_threadId << ". Ignoring addition request." << std::endl;
 				}
 			#endif
 		}
-
-		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
 	}
 
-	VOID remove_approx(IF_PIN_LOCKED_COMMA(const THREADID threadId) uint8_t * const start_address, uint8_t const * const end_address, const bool giveAwayRecords) {
+	VOID add_approx(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t * const start_address, uint8_t const * const end_address, const int64_t bufferId, const int64_t configurationId, const uint32_t dataSizeInBytes IF_COMMA_STACK_ACCESS_ELISION(const ADDRINT stackPointer)) {
 		const Range range = Range(start_address, end_address);
-		ThreadControl& mainThread = PintoolControl::g_mainThreadControl;	
 
 		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
 
+		#if ADAPTIVE_INSTRUMENTATION
+			AdaptiveInstrumentation::RestoreInstrumentation();
+		#endif
+
+		#if MULTIPLE_ACTIVE_BUFFERS
+			ActiveBuffers::const_iterator lbActiveMain = PintoolControl::g_mainThreadControl.m_activeBuffers.cbegin();
+		#endif
+
+		PintoolControl::AddBuffer(IF_PIN_LOCKED_COMMA(*threadControl) range, bufferId, configurationId, dataSizeInBytes IF_COMMA_STACK_ACCESS_ELISION(stackPointer) IF_COMMA_MULTIPLE_ACTIVE_BUFFERS(lbActiveMain));
+
+		#if LIVE_STATISTICS
+			LiveStatistics::g_activeBuffers = PintoolControl::g_mainThreadControl.GetActiveBufferCount();
+		#endif
+
+		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
+	}
+
+	//MUST LOCK
+	void RemoveBuffer(IF_PIN_LOCKED_COMMA(ThreadControl& localThread) const Range& range, const bool giveAwayRecords) {
+		ThreadControl& mainThread = PintoolControl::g_mainThreadControl;
+
 		{
 		#if PIN_LOCKED
-			ThreadControl& localThread = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId))); //TODO: remove approx buffer from both maps
-
+			//TODO: remove approx buffer from both maps
 			#if MULTIPLE_ACTIVE_BUFFERS
 				const ActiveBuffers::const_iterator lbActive = localThread.m_activeBuffers.find(range); 
 				if (lbActive != localThread.m_activeBuffers.cend() && lbActive->first.IsEqual(range)){
 					lbActive->second->RetireBuffer(giveAwayRecords);
+					PintoolControl::SetVisibility(localThread, *lbActive->second, false);
 					localThread.m_activeBuffers.erase(lbActive);
 				}
 			#else
@@ -310,7 +718,7 @@ namespace PintoolControl {
 				}
 			#endif
 			  else {
-				std::cout << "ApproxSS Warning: approximate buffer not found for removal in thread " << threadId << ". Ignorning request." << std::endl;
+				std::cout << "ApproxSS Warning: approximate buffer not found for removal in thread " << localThread.m_threadId << ". Ignorning request." << std::endl;
 			}
 		#endif
 		}
@@ -319,7 +727,14 @@ namespace PintoolControl {
 			const ActiveBuffers::const_iterator lbActive = mainThread.m_activeBuffers.find(range); 
 			if (lbActive != mainThread.m_activeBuffers.cend() && lbActive->first.IsEqual(range)){
 				if (lbActive->second->RetireBuffer(giveAwayRecords)) {
-					mainThread.m_activeBuffers.erase(lbActive); 
+					IF_PIN_LOCKED(PintoolControl::ReleaseVisibilitySlot(*lbActive->second);)
+					#if SHADOW_MEMORY_LOOKUP
+						ChosenTermApproximateBuffer& approxBuffer = *lbActive->second;
+						mainThread.m_activeBuffers.erase(lbActive); 
+						PintoolControl::RemoveFromShadowMemory(mainThread.m_activeBuffers, approxBuffer); //only once it is out, so that its pages are recomputed without it
+					#else
+						mainThread.m_activeBuffers.erase(lbActive); 
+					#endif
 				}
 			}
 		#else
@@ -334,13 +749,131 @@ namespace PintoolControl {
 				std::cout << "ApproxSS Warning: approximate buffer not found for removal. Ignorning request." << std::endl;
 			}
 		#endif
+	}
+
+	VOID remove_approx(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t * const start_address, uint8_t const * const end_address, const bool giveAwayRecords) {
+		const Range range = Range(start_address, end_address);
+
+		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+
+		PintoolControl::RemoveBuffer(IF_PIN_LOCKED_COMMA(*threadControl) range, giveAwayRecords);
+
+		#if LIVE_STATISTICS
+			LiveStatistics::g_activeBuffers = PintoolControl::g_mainThreadControl.GetActiveBufferCount();
+		#endif
+
+		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
+	}
+
+	//mirrors ApproxSS::approx_descriptor (instrumentation_dummies/approx.h), read straight from the target application's memory
+	struct BufferDescriptor {
+		uint8_t* m_startAddress;
+		uint8_t const * m_endAddress;
+		int64_t m_bufferId;
+		int64_t m_configurationId;
+		uint32_t m_dataSizeInBytes;
+	};
+
+	static_assert(sizeof(BufferDescriptor) == sizeof(ApproxSS::approx_descriptor), "BufferDescriptor must match the layout of ApproxSS::approx_descriptor");
+	static_assert(offsetof(BufferDescriptor, m_startAddress) == offsetof(ApproxSS::approx_descriptor, start_address), "BufferDescriptor must match the layout of ApproxSS::approx_descriptor");
+	static_assert(offsetof(BufferDescriptor, m_endAddress) == offsetof(ApproxSS::approx_descriptor, end_address), "BufferDescriptor must match the layout of ApproxSS::approx_descriptor");
+	static_assert(offsetof(BufferDescriptor, m_bufferId) == offsetof(ApproxSS::approx_descriptor, bufferId), "BufferDescriptor must match the layout of ApproxSS::approx_descriptor");
+	static_assert(offsetof(BufferDescriptor, m_configurationId) == offsetof(ApproxSS::approx_descriptor, configurationId), "BufferDescriptor must match the layout of ApproxSS::approx_descriptor");
+	static_assert(offsetof(BufferDescriptor, m_dataSizeInBytes) == offsetof(ApproxSS::approx_descriptor, dataSizeInBytes), "BufferDescriptor must match the layout of ApproxSS::approx_descriptor");
+
+	static void CheckBatch(BufferDescriptor const * const descriptors, const uint64_t count) {
+		if (descriptors == nullptr && count != 0) {
+			std::cerr << "ApproxSS Error: null descriptor array given for a batch of " << count << " approximate buffers." << std::endl;
+			PIN_ExitProcess(EXIT_FAILURE);
+		}
+	}
+
+	//only the first of overlapping ranges is added, so the result of a batch with overlapping descriptors depends on their order
+	static bool HasOverlappingDescriptors(const std::vector<BufferDescriptor const *>& sortedDescriptors) {
+		uint8_t const * coveredUpTo = nullptr;
+
+		for (BufferDescriptor const * const descriptor : sortedDescriptors) {
+			if (descriptor->m_startAddress < coveredUpTo) {
+				return true;
+			}
+
+			coveredUpTo = std::max(coveredUpTo, descriptor->m_endAddress);
+		}
+
+		return false;
+	}
+
+	//the whole batch takes a single lock acquisition. buffers are added in ascending address order, so each search of the active buffers starts where the previous one ended
+	//batches with overlapping descriptors are added in their own order instead (with a full search each), as separate add_approx calls would
+	VOID add_approx_batch(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) BufferDescriptor const * const descriptors, const uint64_t count IF_COMMA_STACK_ACCESS_ELISION(const ADDRINT stackPointer)) {
+		PintoolControl::CheckBatch(descriptors, count);
+
+		std::vector<BufferDescriptor const *> orderedDescriptors(count);
+		for (uint64_t i = 0; i < count; ++i) {
+			orderedDescriptors[i] = descriptors + i;
+		}
+
+		std::sort(orderedDescriptors.begin(), orderedDescriptors.end(), [](BufferDescriptor const * const lhv, BufferDescriptor const * const rhv) {
+			return (lhv->m_startAddress != rhv->m_startAddress) ? (lhv->m_startAddress < rhv->m_startAddress) : (lhv->m_endAddress < rhv->m_endAddress);
+		});
+
+		const bool isInArrayOrder = PintoolControl::HasOverlappingDescriptors(orderedDescriptors); //sorted at this point
+		if (isInArrayOrder) {
+			for (uint64_t i = 0; i < count; ++i) {
+				orderedDescriptors[i] = descriptors + i;
+			}
+		}
+
+		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+
+		#if ADAPTIVE_INSTRUMENTATION
+			if (count != 0) {
+				AdaptiveInstrumentation::RestoreInstrumentation();
+			}
+		#endif
+
+		#if MULTIPLE_ACTIVE_BUFFERS
+			ActiveBuffers::const_iterator lbActiveMain = PintoolControl::g_mainThreadControl.m_activeBuffers.cbegin();
+		#endif
+
+		for (BufferDescriptor const * const descriptor : orderedDescriptors) {
+			const Range range = Range(descriptor->m_startAddress, descriptor->m_endAddress);
+
+			#if MULTIPLE_ACTIVE_BUFFERS
+				if (isInArrayOrder) {
+					lbActiveMain = PintoolControl::g_mainThreadControl.m_activeBuffers.cbegin(); //the previous position is only a valid hint for ascending ranges
+				}
+			#endif
+
+			PintoolControl::AddBuffer(IF_PIN_LOCKED_COMMA(*threadControl) range, descriptor->m_bufferId, descriptor->m_configurationId, descriptor->m_dataSizeInBytes IF_COMMA_STACK_ACCESS_ELISION(stackPointer) IF_COMMA_MULTIPLE_ACTIVE_BUFFERS(lbActiveMain));
+		}
+
+		#if LIVE_STATISTICS
+			LiveStatistics::g_activeBuffers = PintoolControl::g_mainThreadControl.GetActiveBufferCount();
+		#endif
+
+		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
+	}
+
+	//only the addresses of the descriptors are used
+	VOID remove_approx_batch(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) BufferDescriptor const * const descriptors, const uint64_t count, const bool giveAwayRecords) {
+		PintoolControl::CheckBatch(descriptors, count);
+
+		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+
+		for (uint64_t i = 0; i < count; ++i) {
+			const Range range = Range(descriptors[i].m_startAddress, descriptors[i].m_endAddress);
+			PintoolControl::RemoveBuffer(IF_PIN_LOCKED_COMMA(*threadControl) range, giveAwayRecords);
+		}
+
+		#if LIVE_STATISTICS
+			LiveStatistics::g_activeBuffers = PintoolControl::g_mainThreadControl.GetActiveBufferCount();
+		#endif
 
 		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
 	}
 
 	#if PIN_LOCKED
-		static PIN_LOCK tcMap_lock;
-			
 		VOID ThreadStart(const THREADID threadId, CONTEXT * ctxt, const INT32 flags, VOID * v) {
 			std::cout << std::endl << "Target application thread STARTED. Id: " << threadId  << std::endl;
 
@@ -348,15 +881,13 @@ namespace PintoolControl {
 			const std::pair<const ThreadControlMap::const_iterator, const bool> it = PintoolControl::threadControlMap.insert({threadId, std::make_unique<ThreadControl>(threadId)});
 			PIN_ReleaseLock(&tcMap_lock);
 
-			if (PIN_SetThreadData(g_tlsKey, it.first->second.get(), threadId) == FALSE) {
-				std::cerr << "Pin Error: PIN_SetThreadData failed" << std::endl;
-				PIN_ExitProcess(EXIT_FAILURE);
-			}
+			//the object outlives the thread (it is only erased at ThreadFini), so its address can be kept in the thread's tool register
+			PIN_SetContextReg(ctxt, g_threadControlReg, reinterpret_cast<ADDRINT>(it.first->second.get()));
 		}
 		
 		// This function is called when the thread exits
 		VOID ThreadFini(const THREADID threadId, CONTEXT const * const ctxt, const INT32 code, VOID * v) {
-			ThreadControl& tdata = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId)));
+			ThreadControl& tdata = *(reinterpret_cast<ThreadControl*>(PIN_GetContextReg(ctxt, g_threadControlReg)));
 
 			std::cout << std::endl << "Target application thread ENDED: " << threadId << ". Final level: " << tdata.m_level << std::endl;
 
@@ -372,7 +903,7 @@ namespace PintoolControl {
 /* ==================================================================== */
 
 namespace AccessHandler {
-	/*static bool ShouldInject(IF_PIN_LOCKED_COMMA(const THREADID threadId) IF_PIN_LOCKED(const Range& range)) {
+	/*static bool ShouldInject(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) IF_PIN_LOCKED(const Range& range)) {
 		#if PIN_LOCKED
 			const ThreadControl& localThread = *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId)));
 			return localThread.HasActiveBuffer() && localThread.isThreadInjectionEnabled() && localThread.IsPresent(range);
@@ -381,27 +912,109 @@ namespace AccessHandler {
 			return mainThread.isThreadInjectionEnabled();
 		#endif
 	}*/
-	static const ThreadControl& GetInterestThreadControl(IF_PIN_LOCKED(const THREADID threadId)) {
+	static const ThreadControl& GetInterestThreadControl(IF_PIN_LOCKED(ThreadControl const * const threadControl)) {
 		#if PIN_LOCKED
-			return *(static_cast<ThreadControl*>(PIN_GetThreadData(g_tlsKey, threadId)));
+			return *threadControl;
 		#else
 			return PintoolControl::g_mainThreadControl;
 		#endif
 	}
 
 	#if PIN_LOCKED
-		static bool IsPresent(IF_PIN_LOCKED_COMMA(const ThreadControl& threadControl) IF_PIN_LOCKED(const Range& range)) {
-			#if PIN_LOCKED
-				return threadControl.IsPresent(range);
-			#else
-				return true;
+		//whether the buffer was added by the accessing thread, from its visibility mask when the buffer has a slot
+		static bool IsPresent(const ThreadControl& threadControl, ChosenTermApproximateBuffer const & approxBuffer, const Range& range) {
+			#if MULTIPLE_ACTIVE_BUFFERS
+				const uint32_t slot = approxBuffer.GetVisibilitySlot();
+				if (slot != ApproximateBuffer::NO_VISIBILITY_SLOT) {
+					return (threadControl.m_visibleSlots >> slot) & 1;
+				}
+			#endif
+
+			return threadControl.IsPresent(range);
+		}
+	#endif
+
+	#if THREAD_PRIVATE_ACCESS_COUNTING
+		//MUST LOCK
+		//the accessing thread's counters for the buffer, nullptr (counted straight in the period log) if the buffer has no visibility slot or was not added by the thread
+		static inline ThreadAccessCounts* GetThreadAccessCounts(const ThreadControl& threadControl, ChosenTermApproximateBuffer& approxBuffer) {
+			const uint32_t slot = approxBuffer.GetVisibilitySlot();
+			if (slot == ApproximateBuffer::NO_VISIBILITY_SLOT || !((threadControl.m_visibleSlots >> slot) & 1)) {
+				return nullptr;
+			}
+
+			ThreadAccessCounts*& threadCounts = threadControl.m_accessCounts[slot];
+			if (threadCounts == nullptr) {
+				threadCounts = &approxBuffer.GetThreadAccessCounts(threadControl.m_threadId);
+			}
+
+			return threadCounts;
+		}
+	#endif
+
+	#if MULTIPLE_ACTIVE_BUFFERS
+		//the active buffer holding the address, nullptr if none
+		//with the shadow memory, only pages shared by several buffers still need the search in the active buffers
+		static inline ChosenTermApproximateBuffer* FindActiveBuffer(const ThreadControl& mainThread, uint8_t* const accessedAddress) {
+			#if SHADOW_MEMORY_LOOKUP
+				const ShadowMemory::Slot slot = ShadowMemory::GetSlot(accessedAddress);
+				if (slot == ShadowMemory::NO_BUFFER) {
+					return nullptr;
+				}
+
+				if (slot != ShadowMemory::SHARED_PAGE) {
+					ChosenTermApproximateBuffer* const approxBuffer = PintoolControl::shadowSlotBuffers[slot];
+					return approxBuffer->DoesIntersectWith(accessedAddress) ? approxBuffer : nullptr;
+				}
 			#endif
+
+			//a one-byte range, as an empty one at a buffer's first byte would be ordered before the buffer instead of matching it (and disagree with the slot path)
+			const ActiveBuffers::const_iterator it = mainThread.m_activeBuffers.find(Range(accessedAddress, accessedAddress + 1));
+			return (it != mainThread.m_activeBuffers.cend()) ? it->second : nullptr;
 		}
 	#endif
 
-	VOID CheckAndForward(IF_PIN_LOCKED_COMMA(const THREADID threadId) void (ChosenTermApproximateBuffer::*function)(uint8_t* const, const UINT32, const bool IF_COMMA_PIN_LOCKED(const bool)), uint8_t* const accessedAddress, const UINT32 accessSizeInBytes) {
+	//statically dispatched on the (final) buffer type instead of through a member function pointer, so each analysis routine gets a direct, inlinable call to its handler
+	template <size_t accessType, bool isSIMD>
+	static inline void ForwardAccess(ChosenTermApproximateBuffer& approxBuffer, uint8_t* const accessedAddress, const UINT32 accessSizeInBytes, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+		#if LAZY_PERIOD_ADVANCEMENT
+			approxBuffer.CatchUpPeriod();
+		#endif
+
+		if constexpr (accessType == AccessTypes::Read && isSIMD) {
+			approxBuffer.HandleMemoryReadSIMD(accessedAddress, accessSizeInBytes, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+		} else if constexpr (accessType == AccessTypes::Read) {
+			approxBuffer.HandleMemoryReadSingleElementSafe(accessedAddress, accessSizeInBytes, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+		} else if constexpr (isSIMD) {
+			approxBuffer.HandleMemoryWriteSIMD(accessedAddress, accessSizeInBytes, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+		} else {
+			approxBuffer.HandleMemoryWriteSingleElementSafe(accessedAddress, accessSizeInBytes, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+		}
+	}
+
+	template <size_t accessType>
+	static inline void ForwardScatteredAccess(ChosenTermApproximateBuffer& approxBuffer, IMULTI_ELEMENT_OPERAND const * const memOpInfo, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+		#if LAZY_PERIOD_ADVANCEMENT
+			approxBuffer.CatchUpPeriod();
+		#endif
+
+		if constexpr (accessType == AccessTypes::Read) {
+			approxBuffer.HandleMemoryReadScattered(memOpInfo, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+		} else {
+			approxBuffer.HandleMemoryWriteScattered(memOpInfo, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+		}
+	}
+
+	template <size_t accessType, bool isSIMD>
+	VOID CheckAndForward(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile) IF_COMMA_INSTRUCTION_ADDRESS(const ADDRINT instructionAddress)) {
+		PROFILE_SCOPE(CheckAndForward)
+		PROFILE_ACCESS_SIZE(accessSizeInBytes)
+
 		#if PIN_LOCKED
 			if (!PintoolControl::g_mainThreadControl.HasActiveBuffer())	{
+				#if ADAPTIVE_INSTRUMENTATION
+					AdaptiveInstrumentation::RecordExecution(profile, instructionAddress, false);
+				#endif
 				return;
 			}
 		#endif
@@ -410,22 +1023,39 @@ namespace AccessHandler {
 
 		const ThreadControl& mainThread = PintoolControl::g_mainThreadControl;
 
-		#if MULTIPLE_ACTIVE_BUFFERS || PIN_LOCKED
-			const Range range = Range(accessedAddress, accessedAddress);
+		#if PIN_LOCKED
+			const Range range = Range(accessedAddress, accessedAddress + 1); //the accessed byte, see FindActiveBuffer
 		#endif
 
 		#if MULTIPLE_ACTIVE_BUFFERS
-			const ActiveBuffers::const_iterator it =  mainThread.m_activeBuffers.find(range);
-			if (it != mainThread.m_activeBuffers.cend()) {
-				ChosenTermApproximateBuffer& approxBuffer = *(it->second);
-				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadId));
-				(approxBuffer.*function)(accessedAddress, accessSizeInBytes, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, range)));
+			PROFILE_SECTION_START(BufferLookup)
+			ChosenTermApproximateBuffer* const foundBuffer = AccessHandler::FindActiveBuffer(mainThread, accessedAddress);
+			PROFILE_SECTION_END(BufferLookup)
+
+			#if ADAPTIVE_INSTRUMENTATION
+				AdaptiveInstrumentation::RecordExecution(profile, instructionAddress, foundBuffer != nullptr);
+			#endif
+
+			if (foundBuffer != nullptr) {
+				ChosenTermApproximateBuffer& approxBuffer = *foundBuffer;
+				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadControl));
+				ATTRIBUTION_BEGIN(instructionAddress)
+				AccessHandler::ForwardAccess<accessType, isSIMD>(approxBuffer, accessedAddress, accessSizeInBytes, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, approxBuffer, range)) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(AccessHandler::GetThreadAccessCounts(interestControl, approxBuffer)));
+				ATTRIBUTION_END()
 			}
 		#else
-			if (mainThread.m_activeBuffer != nullptr && mainThread.m_activeBuffer->DoesIntersectWith(accessedAddress)) {
+			const bool isHit = (mainThread.m_activeBuffer != nullptr && mainThread.m_activeBuffer->DoesIntersectWith(accessedAddress));
+
+			#if ADAPTIVE_INSTRUMENTATION
+				AdaptiveInstrumentation::RecordExecution(profile, instructionAddress, isHit);
+			#endif
+
+			if (isHit) {
 				ChosenTermApproximateBuffer& approxBuffer = *(mainThread.m_activeBuffer);
-				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadId));
-				(approxBuffer.*function)(accessedAddress, accessSizeInBytes, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, range)));
+				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadControl));
+				ATTRIBUTION_BEGIN(instructionAddress)
+				AccessHandler::ForwardAccess<accessType, isSIMD>(approxBuffer, accessedAddress, accessSizeInBytes, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, approxBuffer, range)) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(AccessHandler::GetThreadAccessCounts(interestControl, approxBuffer)));
+				ATTRIBUTION_END()
 			}
 		#endif
 
@@ -433,76 +1063,402 @@ namespace AccessHandler {
 	}
 
 	// memory read
-	VOID HandleMemoryReadSIMD(IF_PIN_LOCKED_COMMA(const THREADID threadId) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes) {		
-		CheckAndForward(IF_PIN_LOCKED_COMMA(threadId) &ChosenTermApproximateBuffer::HandleMemoryReadSIMD, accessedAddress, accessSizeInBytes);
+	VOID HandleMemoryReadSIMD(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile) IF_COMMA_INSTRUCTION_ADDRESS(const ADDRINT instructionAddress)) {		
+		AccessHandler::CheckAndForward<AccessTypes::Read, true>(IF_PIN_LOCKED_COMMA(threadControl) accessedAddress, accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(profile) IF_COMMA_INSTRUCTION_ADDRESS(instructionAddress));
 	}
 
-	VOID HandleMemoryRead(IF_PIN_LOCKED_COMMA(const THREADID threadId) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes) {		
-		CheckAndForward(IF_PIN_LOCKED_COMMA(threadId) &ChosenTermApproximateBuffer::HandleMemoryReadSingleElementSafe, accessedAddress, accessSizeInBytes);
+	VOID HandleMemoryRead(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile) IF_COMMA_INSTRUCTION_ADDRESS(const ADDRINT instructionAddress)) {		
+		AccessHandler::CheckAndForward<AccessTypes::Read, false>(IF_PIN_LOCKED_COMMA(threadControl) accessedAddress, accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(profile) IF_COMMA_INSTRUCTION_ADDRESS(instructionAddress));
 	}
 
 	// memory write
-	VOID HandleMemoryWriteSIMD(IF_PIN_LOCKED_COMMA(const THREADID threadId) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes) {
-		CheckAndForward(IF_PIN_LOCKED_COMMA(threadId) &ChosenTermApproximateBuffer::HandleMemoryWriteSIMD, accessedAddress, accessSizeInBytes);
+	VOID HandleMemoryWriteSIMD(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile) IF_COMMA_INSTRUCTION_ADDRESS(const ADDRINT instructionAddress)) {
+		AccessHandler::CheckAndForward<AccessTypes::Write, true>(IF_PIN_LOCKED_COMMA(threadControl) accessedAddress, accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(profile) IF_COMMA_INSTRUCTION_ADDRESS(instructionAddress));
+	}
+
+	VOID HandleMemoryWrite(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile) IF_COMMA_INSTRUCTION_ADDRESS(const ADDRINT instructionAddress)) {
+		AccessHandler::CheckAndForward<AccessTypes::Write, false>(IF_PIN_LOCKED_COMMA(threadControl) accessedAddress, accessSizeInBytes IF_COMMA_ADAPTIVE_INSTRUMENTATION(profile) IF_COMMA_INSTRUCTION_ADDRESS(instructionAddress));
+	}
+
+	template <size_t accessType>
+	VOID CheckAndForwardScattered(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) IMULTI_ELEMENT_OPERAND const * const memOpInfo IF_COMMA_INSTRUCTION_ATTRIBUTION(const ADDRINT instructionAddress)) {
+		PROFILE_SCOPE(CheckAndForward)
+
+		#if PIN_LOCKED
+			if (!PintoolControl::g_mainThreadControl.HasActiveBuffer())	{
+				return;
+			}
+		#endif
+
+		if (memOpInfo->NumOfElements() < 1) {
+			return;
+		}
+		
+		uint8_t * accessedAddress = (uint8_t*) memOpInfo->ElementAddress(0); 
+		ThreadControl& mainThread = PintoolControl::g_mainThreadControl;
+
+		#if PIN_LOCKED
+			const Range range = Range(accessedAddress, accessedAddress + 1); //the accessed byte, see FindActiveBuffer
+		#endif
+		
+		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+		
+		#if MULTIPLE_ACTIVE_BUFFERS
+			PROFILE_SECTION_START(BufferLookup)
+			ChosenTermApproximateBuffer* const foundBuffer = AccessHandler::FindActiveBuffer(mainThread, accessedAddress);
+			PROFILE_SECTION_END(BufferLookup)
+			if (foundBuffer != nullptr) {
+				ChosenTermApproximateBuffer& approxBuffer = *foundBuffer;
+
+				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadControl));
+
+				ATTRIBUTION_BEGIN(instructionAddress)
+				AccessHandler::ForwardScatteredAccess<accessType>(approxBuffer, memOpInfo, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, approxBuffer, range)) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(AccessHandler::GetThreadAccessCounts(interestControl, approxBuffer)));
+				ATTRIBUTION_END()
+			}
+		#else
+			if (mainThread.m_activeBuffer != nullptr && mainThread.m_activeBuffer->DoesIntersectWith(accessedAddress)) {
+				ChosenTermApproximateBuffer& approxBuffer = *(mainThread.m_activeBuffer);
+
+				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadControl));
+
+				ATTRIBUTION_BEGIN(instructionAddress)
+				AccessHandler::ForwardScatteredAccess<accessType>(approxBuffer, memOpInfo, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, approxBuffer, range)) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(AccessHandler::GetThreadAccessCounts(interestControl, approxBuffer)));
+				ATTRIBUTION_END()
+			}
+		#endif
+
+		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
+	}
+
+	VOID HandleMemoryReadScattered(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) IMULTI_ELEMENT_OPERAND const * const memOpInfo IF_COMMA_INSTRUCTION_ATTRIBUTION(const ADDRINT instructionAddress)) {
+		AccessHandler::CheckAndForwardScattered<AccessTypes::Read>(IF_PIN_LOCKED_COMMA(threadControl) memOpInfo IF_COMMA_INSTRUCTION_ATTRIBUTION(instructionAddress));
+	}
+
+	VOID HandleMemoryWriteScattered(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) IMULTI_ELEMENT_OPERAND const * const memOpInfo IF_COMMA_INSTRUCTION_ATTRIBUTION(const ADDRINT instructionAddress)) {
+		AccessHandler::CheckAndForwardScattered<AccessTypes::Write>(IF_PIN_LOCKED_COMMA(threadControl) memOpInfo IF_COMMA_INSTRUCTION_ATTRIBUTION(instructionAddress));
+	}
+
+	#if RANGE_ACCESS_HANDLING
+		template <size_t accessType>
+		static inline void ForwardRangeAccess(ChosenTermApproximateBuffer& approxBuffer, uint8_t* const initialAddress, uint8_t const * const finalAddress, const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(ThreadAccessCounts* const threadCounts)) {
+			#if LAZY_PERIOD_ADVANCEMENT
+				approxBuffer.CatchUpPeriod();
+			#endif
+
+			if constexpr (accessType == AccessTypes::Read) {
+				approxBuffer.HandleMemoryReadRange(initialAddress, finalAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+			} else {
+				approxBuffer.HandleMemoryWriteRange(initialAddress, finalAddress, isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(isBufferInThread) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(threadCounts));
+			}
+		}
+
+		//returns whether the range intersected any approximate buffer
+		template <size_t accessType>
+		bool CheckAndForwardRange(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const initialAddress, uint8_t const * const finalAddress IF_COMMA_INSTRUCTION_ATTRIBUTION(const ADDRINT instructionAddress)) {
+			PROFILE_SCOPE(CheckAndForward)
+
+			#if PIN_LOCKED
+				if (!PintoolControl::g_mainThreadControl.HasActiveBuffer())	{
+					return false;
+				}
+			#endif
+
+			IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+
+			const ThreadControl& mainThread = PintoolControl::g_mainThreadControl;
+			const Range range = Range(initialAddress, finalAddress);
+
+			#if MULTIPLE_ACTIVE_BUFFERS
+				//a single range may go through several buffers, every intersecting one gets its own part of it
+				PROFILE_SECTION_START(BufferLookup)
+				ActiveBuffers::const_iterator it = mainThread.m_activeBuffers.lower_bound(range);
+				PROFILE_SECTION_END(BufferLookup)
+
+				const bool isHit = (it != mainThread.m_activeBuffers.cend() && it->first.DoesIntersectWith(range));
+
+				if (isHit) {
+					ATTRIBUTION_BEGIN(instructionAddress)
+				}
+
+				for (; it != mainThread.m_activeBuffers.cend() && it->first.DoesIntersectWith(range); ++it) {
+					ChosenTermApproximateBuffer& approxBuffer = *(it->second);
+					const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadControl));
+					AccessHandler::ForwardRangeAccess<accessType>(approxBuffer, initialAddress, finalAddress, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, approxBuffer, it->first)) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(AccessHandler::GetThreadAccessCounts(interestControl, approxBuffer)));
+				}
+
+				ATTRIBUTION_END()
+			#else
+				const bool isHit = (mainThread.m_activeBuffer != nullptr && mainThread.m_activeBuffer->DoesIntersectWith(range));
+
+				if (isHit) {
+					ChosenTermApproximateBuffer& approxBuffer = *(mainThread.m_activeBuffer);
+					const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadControl));
+					ATTRIBUTION_BEGIN(instructionAddress)
+					AccessHandler::ForwardRangeAccess<accessType>(approxBuffer, initialAddress, finalAddress, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, approxBuffer, range)) IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(AccessHandler::GetThreadAccessCounts(interestControl, approxBuffer)));
+					ATTRIBUTION_END()
+				}
+			#endif
+
+			IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
+
+			return isHit;
+		}
+	#endif
+
+	#if REP_STRING_RANGE_ACCESS
+		static const ADDRINT DIRECTION_FLAG = 0x400;
+
+		//called only on the first iteration, when the count register still holds the total number of iterations
+		static Range GetRepeatedRange(uint8_t* const firstAddress, const UINT32 elementSize, const ADDRINT count, const ADDRINT flags) {
+			const size_t sizeInBytes = static_cast<size_t>(count) * elementSize;
+
+			if (flags & DIRECTION_FLAG) { //backwards, from the highest element down
+				uint8_t* const initialAddress = firstAddress + elementSize - sizeInBytes;
+				return Range(initialAddress, initialAddress + sizeInBytes);
+			}
+
+			return Range(firstAddress, firstAddress + sizeInBytes);
+		}
+
+		ADDRINT IsFirstRepIteration(const BOOL isFirstIteration) {
+			return isFirstIteration;
+		}
+
+		VOID HandleRepeatedMemoryRead(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const firstAddress, const UINT32 elementSize, const ADDRINT count, const ADDRINT flags IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile) IF_COMMA_INSTRUCTION_ADDRESS(const ADDRINT instructionAddress)) {
+			const Range range = AccessHandler::GetRepeatedRange(firstAddress, elementSize, count, flags);
+			const bool isHit = AccessHandler::CheckAndForwardRange<AccessTypes::Read>(IF_PIN_LOCKED_COMMA(threadControl) range.m_initialAddress, range.m_finalAddress IF_COMMA_INSTRUCTION_ATTRIBUTION(instructionAddress));
+
+			#if ADAPTIVE_INSTRUMENTATION
+				AdaptiveInstrumentation::RecordExecution(profile, instructionAddress, isHit);
+			#else
+				(void) isHit;
+			#endif
+		}
+
+		VOID HandleRepeatedMemoryWrite(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const firstAddress, const UINT32 elementSize, const ADDRINT count, const ADDRINT flags IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile) IF_COMMA_INSTRUCTION_ADDRESS(const ADDRINT instructionAddress)) {
+			const Range range = AccessHandler::GetRepeatedRange(firstAddress, elementSize, count, flags);
+			const bool isHit = AccessHandler::CheckAndForwardRange<AccessTypes::Write>(IF_PIN_LOCKED_COMMA(threadControl) range.m_initialAddress, range.m_finalAddress IF_COMMA_INSTRUCTION_ATTRIBUTION(instructionAddress));
+
+			#if ADAPTIVE_INSTRUMENTATION
+				AdaptiveInstrumentation::RecordExecution(profile, instructionAddress, isHit);
+			#else
+				(void) isHit;
+			#endif
+		}
+	#endif
+
+	#if BULK_OPERATION_INTERCEPTION
+		//memcpy, memmove and mempcpy: the whole source is read before the whole destination is written, so that, on overlaps, the write supersedes the read
+		VOID HandleBulkCopy(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const destination, uint8_t* const source, const ADDRINT sizeInBytes IF_COMMA_INSTRUCTION_ATTRIBUTION(const ADDRINT returnAddress)) {
+			if (sizeInBytes == 0) {
+				return;
+			}
+
+			AccessHandler::CheckAndForwardRange<AccessTypes::Read>(IF_PIN_LOCKED_COMMA(threadControl) source, source + sizeInBytes IF_COMMA_INSTRUCTION_ATTRIBUTION(returnAddress));
+			AccessHandler::CheckAndForwardRange<AccessTypes::Write>(IF_PIN_LOCKED_COMMA(threadControl) destination, destination + sizeInBytes IF_COMMA_INSTRUCTION_ATTRIBUTION(returnAddress));
+		}
+
+		//memset, wmemset and bzero
+		VOID HandleBulkSet(IF_PIN_LOCKED_COMMA(ThreadControl * const threadControl) uint8_t* const destination, const ADDRINT count, const UINT32 unitSizeInBytes IF_COMMA_INSTRUCTION_ATTRIBUTION(const ADDRINT returnAddress)) {
+			if (count == 0) {
+				return;
+			}
+
+			AccessHandler::CheckAndForwardRange<AccessTypes::Write>(IF_PIN_LOCKED_COMMA(threadControl) destination, destination + count * unitSizeInBytes IF_COMMA_INSTRUCTION_ATTRIBUTION(returnAddress));
+		}
+	#endif
+
+	//only for code left out by the instrumentation allow-lists, in warning mode: counts, but never forwards, accesses to approximate buffers
+	VOID ReportExcludedAccess(InstrumentationFilter::ExcludedRoutine * const excluded, uint8_t* const accessedAddress) {
+		#if PIN_LOCKED
+			if (!PintoolControl::g_mainThreadControl.HasActiveBuffer())	{
+				return;
+			}
+		#endif
+
+		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+
+		const ThreadControl& mainThread = PintoolControl::g_mainThreadControl;
+
+		#if MULTIPLE_ACTIVE_BUFFERS
+			if (AccessHandler::FindActiveBuffer(mainThread, accessedAddress) != nullptr) {
+				++excluded->m_approximateAccesses;
+			}
+		#else
+			if (mainThread.m_activeBuffer != nullptr && mainThread.m_activeBuffer->DoesIntersectWith(accessedAddress)) {
+				++excluded->m_approximateAccesses;
+			}
+		#endif
+
+		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
+	}
+
+	VOID ReportExcludedScatteredAccess(InstrumentationFilter::ExcludedRoutine * const excluded, IMULTI_ELEMENT_OPERAND const * const memOpInfo) {
+		if (memOpInfo->NumOfElements() < 1) {
+			return;
+		}
+
+		AccessHandler::ReportExcludedAccess(excluded, (uint8_t*) memOpInfo->ElementAddress(0));
 	}
+}
+
+// This function is called before every instruction is executed
+namespace TargetInstrumentation {
+	#if STACK_ACCESS_ELISION
+		//rsp-relative operands (spills, locals) and implicit stack operands (push, pop, call, ret)
+		//rbp-relative ones are NOT elided, as rbp is a general purpose register when frame pointers are omitted
+		static bool IsElidableStackOperand(const INS ins, const UINT32 memOp) {
+			if (PintoolControl::isStackInstrumentationEnabled) {
+				return false;
+			}
+
+			const UINT32 op = INS_MemoryOperandIndexToOperandIndex(ins, memOp);
+			if (INS_OperandMemoryBaseReg(ins, op) == REG_STACK_PTR) {
+				return true;
+			}
+
+			//only the implicit stack slot of push, pop, call and ret. their explicit operand (e.g., push qword ptr table[rax*8]) may well be in an approximate buffer
+			return INS_OperandIsImplicit(ins, op) && (INS_IsStackRead(ins) || INS_IsStackWrite(ins));
+		}
+	#endif
+
+	VOID InstrumentExcludedAccesses(const INS ins) {
+		InstrumentationFilter::ExcludedRoutine * const excluded = InstrumentationFilter::GetExcludedRoutine(ins);
 
-	VOID HandleMemoryWrite(IF_PIN_LOCKED_COMMA(const THREADID threadId) uint8_t* const accessedAddress, const UINT32 accessSizeInBytes) {
-		CheckAndForward(IF_PIN_LOCKED_COMMA(threadId) &ChosenTermApproximateBuffer::HandleMemoryWriteSingleElementSafe, accessedAddress, accessSizeInBytes);
+		const UINT32 memOperands = INS_MemoryOperandCount(ins);
+		for (UINT32 memOp = 0; memOp < memOperands; ++memOp) {
+			if (!INS_HasScatteredMemoryAccess(ins)) {
+				INS_InsertPredicatedCall(
+					ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::ReportExcludedAccess,
+					IARG_PTR, excluded, IARG_MEMORYOP_EA, memOp,
+					IARG_END);
+			} else {
+				const UINT32 op = INS_MemoryOperandIndexToOperandIndex(ins, memOp);
+				INS_InsertPredicatedCall(
+					ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::ReportExcludedScatteredAccess,
+					IARG_PTR, excluded, IARG_MULTI_ELEMENT_OPERAND, op,
+					IARG_END);
+			}
+		}
 	}
 
-	VOID CheckAndForwardScattered(IF_PIN_LOCKED_COMMA(const THREADID threadId) void (ChosenTermApproximateBuffer::*function)(IMULTI_ELEMENT_OPERAND const * const, const bool IF_COMMA_PIN_LOCKED(const bool)), IMULTI_ELEMENT_OPERAND const * const memOpInfo) {
-		#if PIN_LOCKED
-			if (!PintoolControl::g_mainThreadControl.HasActiveBuffer())	{
-				return;
-			}
-		#endif
+	#if REP_STRING_RANGE_ACCESS
+		//rep movs and rep stos (inline memcpy/memset): their count register is exact, unlike the one of rep cmps/scas, which may stop early
+		static bool IsRangeStringOperation(const INS ins) {
+			return INS_HasRealRep(ins) && INS_IsMemoryWrite(ins);
+		}
 
-		if (memOpInfo->NumOfElements() < 1) {
-			return;
+		VOID InstrumentRangeStringOperation(const INS ins, const UINT32 memOp, const AFUNPTR handler IF_COMMA_ADAPTIVE_INSTRUMENTATION(AdaptiveInstrumentation::InstructionProfile * const profile)) {
+			INS_InsertIfPredicatedCall(
+				ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::IsFirstRepIteration,
+				IARG_FIRST_REP_ITERATION,
+				IARG_END);
+			INS_InsertThenPredicatedCall(
+				ins, IPOINT_BEFORE, handler, IARG_THREAD_CONTROL
+				IARG_MEMORYOP_EA, memOp, IARG_UINT32, INS_MemoryOperandSize(ins, memOp),
+				IARG_REG_VALUE, INS_RepCountRegister(ins), IARG_REG_VALUE, REG_GFLAGS, IARG_ADAPTIVE_PROFILE(profile) IARG_INSTRUCTION_ADDRESS
+				IARG_END);
 		}
-		
-		uint8_t * accessedAddress = (uint8_t*) memOpInfo->ElementAddress(0); 
-		ThreadControl& mainThread = PintoolControl::g_mainThreadControl;
+	#endif
 
-		#if MULTIPLE_ACTIVE_BUFFERS || PIN_LOCKED
-			const Range range = Range(accessedAddress, accessedAddress);
-		#endif
-		
-		IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
-		
-		#if MULTIPLE_ACTIVE_BUFFERS
-			const ActiveBuffers::const_iterator it = mainThread.m_activeBuffers.find(range);
-			if (it != mainThread.m_activeBuffers.cend()) {
-				ChosenTermApproximateBuffer& approxBuffer = *(it->second);
+	#if BULK_OPERATION_INTERCEPTION
+		namespace BulkOperations {
+			class BulkRoutine {
+				public:
+					const char* const m_pattern;
+					const bool m_isCopy;
+					const UINT32 m_sizeArgument;
+					const UINT32 m_unitSizeInBytes;
+			};
+
+			//exported names and glibc's multiarch implementations (e.g. __memmove_avx_unaligned_erms)
+			//wmemset and bzero are included because their implementations jump into the (not instrumented) middle of the memset ones
+			const BulkRoutine Routines[] = {
+				{"memcpy",		true,	2, 1},	{"__memcpy_*",		true,	2, 1},
+				{"memmove",		true,	2, 1},	{"__memmove_*",		true,	2, 1},
+				{"mempcpy",		true,	2, 1},	{"__mempcpy_*",		true,	2, 1},
+				{"memset",		false,	2, 1},	{"__memset_*",		false,	2, 1},
+				{"wmemset",		false,	2, sizeof(wchar_t)},	{"__wmemset_*",		false,	2, sizeof(wchar_t)},
+				{"bzero",		false,	1, 1},	{"__bzero_*",		false,	1, 1}
+			};
+
+			//by routine address, only accessed at instrumentation time, dropped when its image is unloaded
+			std::unordered_set<ADDRINT> interceptedRoutines;
+
+			//the _chk variants only check the size and then fall through (or jump) to the entry of an intercepted implementation
+			static BulkRoutine const * FindBulkRoutine(std::string name) {
+				name = name.substr(0, name.find('@'));
+
+				if (name.find("_chk") != std::string::npos) {
+					return nullptr;
+				}
 
-				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadId));
+				for (const BulkRoutine& routine : BulkOperations::Routines) {
+					if (InstrumentationFilter::MatchesGlob(routine.m_pattern, name.c_str())) {
+						return &routine;
+					}
+				}
 
-				(approxBuffer.*function)(memOpInfo, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, range)));
+				return nullptr;
 			}
-		#else
-			if (mainThread.m_activeBuffer != nullptr && mainThread.m_activeBuffer->DoesIntersectWith(accessedAddress)) {
-				ChosenTermApproximateBuffer& approxBuffer = *(mainThread.m_activeBuffer);
 
-				const ThreadControl& interestControl = AccessHandler::GetInterestThreadControl(IF_PIN_LOCKED(threadId));
-
-				(approxBuffer.*function)(memOpInfo, interestControl.isThreadInjectionEnabled() IF_COMMA_PIN_LOCKED(AccessHandler::IsPresent(interestControl, range)));
+			bool IsIntercepted(const INS ins) {
+				const RTN rtn = INS_Rtn(ins);
+				return RTN_Valid(rtn) && BulkOperations::interceptedRoutines.count(RTN_Address(rtn)) != 0;
 			}
-		#endif
 
-		IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);)
-	}
+			//another image may be loaded at the same addresses
+			VOID ForgetRoutines(const IMG img) {
+				const ADDRINT lowAddress = IMG_LowAddress(img);
+				const ADDRINT highAddress = IMG_HighAddress(img); //inclusive
 
-	VOID HandleMemoryReadScattered(IF_PIN_LOCKED_COMMA(const THREADID threadId) IMULTI_ELEMENT_OPERAND const * const memOpInfo) {
-		CheckAndForwardScattered(IF_PIN_LOCKED_COMMA(threadId) &ChosenTermApproximateBuffer::HandleMemoryReadScattered, memOpInfo);
-	}
+				for (std::unordered_set<ADDRINT>::const_iterator it = BulkOperations::interceptedRoutines.cbegin(); it != BulkOperations::interceptedRoutines.cend(); ) {
+					if (*it >= lowAddress && *it <= highAddress) {
+						it = BulkOperations::interceptedRoutines.erase(it);
+					} else {
+						++it;
+					}
+				}
+			}
 
-	VOID HandleMemoryWriteScattered(IF_PIN_LOCKED_COMMA(const THREADID threadId) IMULTI_ELEMENT_OPERAND const * const memOpInfo) {
-		CheckAndForwardScattered(IF_PIN_LOCKED_COMMA(threadId) &ChosenTermApproximateBuffer::HandleMemoryWriteScattered, memOpInfo);
-	}
-}
+			VOID InterceptRoutines(const IMG img) {
+				for (SEC sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec)) {
+					for (RTN rtn = SEC_RtnHead(sec); RTN_Valid(rtn); rtn = RTN_Next(rtn)) {
+						BulkRoutine const * const routine = BulkOperations::FindBulkRoutine(RTN_Name(rtn));
+						if (routine == nullptr || !InstrumentationFilter::ShouldInstrumentRoutine(rtn)) {
+							continue;
+						}
+
+						if (!BulkOperations::interceptedRoutines.insert(RTN_Address(rtn)).second) {
+							continue;
+						}
+
+						RTN_Open(rtn);
+						if (routine->m_isCopy) {
+							RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleBulkCopy,
+											IARG_THREAD_CONTROL
+											IARG_FUNCARG_ENTRYPOINT_VALUE, 0,
+											IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
+											IARG_FUNCARG_ENTRYPOINT_VALUE, routine->m_sizeArgument,
+											IARG_ATTRIBUTED_ADDRESS(IARG_RETURN_IP)
+											IARG_END);
+						} else {
+							RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleBulkSet,
+											IARG_THREAD_CONTROL
+											IARG_FUNCARG_ENTRYPOINT_VALUE, 0,
+											IARG_FUNCARG_ENTRYPOINT_VALUE, routine->m_sizeArgument,
+											IARG_UINT32, routine->m_unitSizeInBytes,
+											IARG_ATTRIBUTED_ADDRESS(IARG_RETURN_IP)
+											IARG_END);
+						}
+						RTN_Close(rtn);
+					}
+				}
+			}
+		}
+	#endif
 
-// This function is called before every instruction is executed
-namespace TargetInstrumentation {
 	// Is called for every instruction and instruments reads and writes
 	VOID Instruction(const INS ins, VOID* v) {
 		// Instruments memory accesses using a predicated call, i.e.
@@ -513,27 +1469,74 @@ namespace TargetInstrumentation {
 
 		ASSERT_ACCESS_INSTRUMENTATION_ACTIVE()
 
+		if (!InstrumentationFilter::ShouldInstrument(ins)) {
+			if (InstrumentationFilter::IsWarningEnabled()) {
+				TargetInstrumentation::InstrumentExcludedAccesses(ins);
+			}
+			return;
+		}
+
+		#if BULK_OPERATION_INTERCEPTION
+			if (BulkOperations::IsIntercepted(ins)) {
+				return;
+			}
+		#endif
+
 		const UINT32 memOperands = INS_MemoryOperandCount(ins);
+
+		#if ADAPTIVE_INSTRUMENTATION
+			if (memOperands == 0) {
+				return;
+			}
+
+			AdaptiveInstrumentation::InstructionProfile * const profile = AdaptiveInstrumentation::GetProfile(ins);
+			if (profile == nullptr) {
+				return;
+			}
+		#endif
+
+		#if REP_STRING_RANGE_ACCESS
+			const bool isRangeStringOperation = TargetInstrumentation::IsRangeStringOperation(ins);
+		#endif
+
 		// Iterate over each memory operand of the instruction.
 		for (UINT32 memOp = 0; memOp < memOperands; ++memOp) {		
+			#if STACK_ACCESS_ELISION
+				if (TargetInstrumentation::IsElidableStackOperand(ins, memOp)) {
+					continue;
+				}
+			#endif
+
+			#if REP_STRING_RANGE_ACCESS
+				if (isRangeStringOperation) {
+					if (INS_MemoryOperandIsRead(ins, memOp)) {
+						TargetInstrumentation::InstrumentRangeStringOperation(ins, memOp, (AFUNPTR)AccessHandler::HandleRepeatedMemoryRead IF_COMMA_ADAPTIVE_INSTRUMENTATION(profile));
+					}
+					if (INS_MemoryOperandIsWritten(ins, memOp)) {
+						TargetInstrumentation::InstrumentRangeStringOperation(ins, memOp, (AFUNPTR)AccessHandler::HandleRepeatedMemoryWrite IF_COMMA_ADAPTIVE_INSTRUMENTATION(profile));
+					}
+					continue;
+				}
+			#endif
+
 			if (INS_MemoryOperandIsRead(ins, memOp)) {
 				if (!INS_HasScatteredMemoryAccess(ins)) {
 					if (INS_MemoryOperandElementCount(ins, memOp) > 1) {
 						INS_InsertPredicatedCall(
-							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryReadSIMD, IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
-							IARG_MEMORYOP_EA, memOp, IARG_MEMORYREAD_SIZE,
+							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryReadSIMD, IARG_THREAD_CONTROL
+							IARG_MEMORYOP_EA, memOp, IARG_MEMORYREAD_SIZE, IARG_ADAPTIVE_PROFILE(profile) IARG_INSTRUCTION_ADDRESS
 							IARG_END);
 					} else {
 						INS_InsertPredicatedCall(
-							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryRead, IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
-							IARG_MEMORYOP_EA, memOp, IARG_MEMORYREAD_SIZE,
+							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryRead, IARG_THREAD_CONTROL
+							IARG_MEMORYOP_EA, memOp, IARG_MEMORYREAD_SIZE, IARG_ADAPTIVE_PROFILE(profile) IARG_INSTRUCTION_ADDRESS
 							IARG_END);
 					}
 				} else {
 					const UINT32 op = INS_MemoryOperandIndexToOperandIndex(ins, memOp);
 					INS_InsertPredicatedCall(
-						ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryReadScattered, IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
-						IARG_MULTI_ELEMENT_OPERAND, op,
+						ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryReadScattered, IARG_THREAD_CONTROL
+						IARG_MULTI_ELEMENT_OPERAND, op, IARG_ATTRIBUTED_ADDRESS(IARG_INST_PTR)
 						IARG_END);
 				}
 			}
@@ -545,20 +1548,20 @@ namespace TargetInstrumentation {
 				if (!INS_HasScatteredMemoryAccess(ins)) {
 					if (INS_MemoryOperandElementCount(ins, memOp) > 1) {
 						INS_InsertPredicatedCall(
-							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryWriteSIMD, IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
-							IARG_MEMORYOP_EA, memOp, IARG_MEMORYWRITE_SIZE,
+							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryWriteSIMD, IARG_THREAD_CONTROL
+							IARG_MEMORYOP_EA, memOp, IARG_MEMORYWRITE_SIZE, IARG_ADAPTIVE_PROFILE(profile) IARG_INSTRUCTION_ADDRESS
 							IARG_END);
 					} else {
 						INS_InsertPredicatedCall(
-							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryWrite, IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
-							IARG_MEMORYOP_EA, memOp, IARG_MEMORYWRITE_SIZE,
+							ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryWrite, IARG_THREAD_CONTROL
+							IARG_MEMORYOP_EA, memOp, IARG_MEMORYWRITE_SIZE, IARG_ADAPTIVE_PROFILE(profile) IARG_INSTRUCTION_ADDRESS
 							IARG_END);
 					}
 				} else {
 					const UINT32 op = INS_MemoryOperandIndexToOperandIndex(ins, memOp);
 					INS_InsertPredicatedCall(
-						ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryWriteScattered, IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
-						IARG_MULTI_ELEMENT_OPERAND, op,
+						ins, IPOINT_BEFORE, (AFUNPTR)AccessHandler::HandleMemoryWriteScattered, IARG_THREAD_CONTROL
+						IARG_MULTI_ELEMENT_OPERAND, op, IARG_ATTRIBUTED_ADDRESS(IARG_INST_PTR)
 						IARG_END);
 				}
 			}
@@ -569,35 +1572,98 @@ namespace TargetInstrumentation {
 	/* Register functions to track										   */
 	/* ===================================================================== */
 
-	VOID Routine(const RTN rtn, VOID* v) {
-		const std::string rtnName = RTN_Name(rtn);
+	//the markers declared in instrumentation_dummies/approx.h
+	namespace Marker {
+		constexpr size_t StartLevel						= 0;
+		constexpr size_t EndLevel						= 1;
+		constexpr size_t NextPeriod						= 2;
+		constexpr size_t AddApprox						= 3;
+		constexpr size_t RemoveApprox					= 4;
+		constexpr size_t AddApproxBatch					= 5;
+		constexpr size_t RemoveApproxBatch				= 6;
+		constexpr size_t EnableGlobalInjection			= 7;
+		constexpr size_t DisableGlobalInjection			= 8;
+		constexpr size_t DisableAccessInstrumentation	= 9;
+		constexpr size_t EnableAccessInstrumentation	= 10;
+		constexpr size_t Size							= 11;
+	}
+
+	const std::array<const std::string, Marker::Size> MarkerNames = {"start_level", "end_level", "next_period", "add_approx", "remove_approx", "add_approx_batch", "remove_approx_batch", "enable_global_injection", "disable_global_injection", "disable_access_instrumentation", "enable_access_instrumentation"};
+
+	//the routines of the image's markers, in a single walk over its routines (RTN_Invalid() for the ones not found)
+	//a marker is matched by its undecorated name, ApproxSS::<marker>, whatever its mangling (so the compiler and the marker's signature do not matter), or by the plain name of an extern "C" declaration
+	std::array<RTN, Marker::Size> FindMarkers(const IMG img) {
+		const std::string qualifier = "ApproxSS::";
+
+		std::array<RTN, Marker::Size> markers;
+		markers.fill(RTN_Invalid());
+
+		for (SEC sec = IMG_SecHead(img); SEC_Valid(sec); sec = SEC_Next(sec)) {
+			for (RTN rtn = SEC_RtnHead(sec); RTN_Valid(rtn); rtn = RTN_Next(rtn)) {
+				const std::string name = RTN_Name(rtn);
+				const std::string undecorated = PIN_UndecorateSymbolName(name, UNDECORATION_NAME_ONLY);
+				const bool isQualified = (undecorated.compare(0, qualifier.size(), qualifier) == 0);
+
+				const size_t marker = std::find(MarkerNames.cbegin(), MarkerNames.cend(), isQualified ? undecorated.substr(qualifier.size()) : undecorated) - MarkerNames.cbegin();
+				if (marker == Marker::Size) {
+					if (isQualified) {
+						std::cout << "ApproxSS Warning: \"" << undecorated << "\" in image \"" << IMG_Name(img) << "\" is in the ApproxSS namespace but is not a marker, so it is not instrumented." << std::endl;
+					}
+					continue;
+				}
+
+				if (!isQualified && undecorated != name) {
+					std::cout << "ApproxSS Warning: \"" << name << "\" in image \"" << IMG_Name(img) << "\" has the name of a marker but is neither in the ApproxSS namespace nor extern \"C\", so it is not instrumented." << std::endl;
+					continue;
+				}
+
+				if (RTN_Valid(markers[marker])) {
+					std::cout << "ApproxSS Warning: marker \"" << MarkerNames[marker] << "\" found more than once in image \"" << IMG_Name(img) << "\", only \"" << RTN_Name(markers[marker]) << "\" is instrumented." << std::endl;
+					continue;
+				}
+
+				markers[marker] = rtn;
+			}
+		}
+
+		return markers;
+	}
+
+	VOID Image(const IMG img, VOID* v) {
+		if (IMG_IsVDSO(img) || IMG_IsInterpreter(img)) {
+			return;
+		}
+
+		const std::array<RTN, Marker::Size> markers = TargetInstrumentation::FindMarkers(img);
+		RTN rtn;
 
 		/*by my experience, if more than one of these functions have the same number of parameters, 
 		they'll end up calling each other. the actual function in the pintool doesn't appear to need the parameters, 
 		but having them in the instrumentalized code is advised, tho i don't really know if necessary*/
 
 		// Insert a call at the entry point of routines
-		if (rtnName.find("start_level") != std::string::npos) {
+		rtn = markers[Marker::StartLevel];
+		if (RTN_Valid(rtn)) {
 			RTN_Open(rtn);
 			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::start_level,  
-							IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
+							IARG_THREAD_CONTROL
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 0,
 							IARG_END);
 			RTN_Close(rtn);
 			SET_ACCESS_INSTRUMENTATION_STATUS(true)
-			return;
 		}
 
-		if (rtnName.find("end_level") != std::string::npos) {
+		rtn = markers[Marker::EndLevel];
+		if (RTN_Valid(rtn)) {
 			RTN_Open(rtn);
 			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::end_level,  
-							IF_PIN_LOCKED_COMMA(IARG_THREAD_ID) IARG_END);
+							IARG_THREAD_CONTROL IARG_END);
 			RTN_Close(rtn);
 			SET_ACCESS_INSTRUMENTATION_STATUS(true)
-			return;
 		}
 
-		if (rtnName.find("next_period") != std::string::npos) {
+		rtn = markers[Marker::NextPeriod];
+		if (RTN_Valid(rtn)) {
 			RTN_Open(rtn);
 			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::next_period,
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
@@ -605,41 +1671,72 @@ namespace TargetInstrumentation {
 							IARG_END);
 			RTN_Close(rtn);
 			SET_ACCESS_INSTRUMENTATION_STATUS(true)
-			return;
 		}
 
-		if (rtnName.find("add_approx") != std::string::npos) {
+		rtn = markers[Marker::AddApprox];
+		if (RTN_Valid(rtn)) {
 			RTN_Open(rtn);
 			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::add_approx, 
-							IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
+							IARG_THREAD_CONTROL
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 2,
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 3,
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 4, 
+							#if STACK_ACCESS_ELISION
+								IARG_REG_VALUE, REG_STACK_PTR,
+							#endif
 							IARG_END);
 			RTN_Close(rtn);
 			SET_ACCESS_INSTRUMENTATION_STATUS(true)
-			return;
 		}
 
-		if (rtnName.find("remove_approx") != std::string::npos) {
+		rtn = markers[Marker::RemoveApprox];
+		if (RTN_Valid(rtn)) {
 			RTN_Open(rtn);
 			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::remove_approx,  
-							IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
+							IARG_THREAD_CONTROL
+							IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
+							IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
+							IARG_FUNCARG_ENTRYPOINT_VALUE, 2, 
+							IARG_END);
+			RTN_Close(rtn);
+			SET_ACCESS_INSTRUMENTATION_STATUS(true)
+		}
+
+		rtn = markers[Marker::AddApproxBatch];
+		if (RTN_Valid(rtn)) {
+			RTN_Open(rtn);
+			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::add_approx_batch, 
+							IARG_THREAD_CONTROL
+							IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
+							IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
+							#if STACK_ACCESS_ELISION
+								IARG_REG_VALUE, REG_STACK_PTR,
+							#endif
+							IARG_END);
+			RTN_Close(rtn);
+			SET_ACCESS_INSTRUMENTATION_STATUS(true)
+		}
+
+		rtn = markers[Marker::RemoveApproxBatch];
+		if (RTN_Valid(rtn)) {
+			RTN_Open(rtn);
+			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::remove_approx_batch,  
+							IARG_THREAD_CONTROL
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 2, 
 							IARG_END);
 			RTN_Close(rtn);
 			SET_ACCESS_INSTRUMENTATION_STATUS(true)
-			return;
 		}
 
-		if (rtnName.find("enable_global_injection") != std::string::npos) {
+		rtn = markers[Marker::EnableGlobalInjection];
+		if (RTN_Valid(rtn)) {
 			RTN_Open(rtn);
 			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::enable_global_injection, 
-							IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
+							IARG_THREAD_CONTROL
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 2,
@@ -647,13 +1744,13 @@ namespace TargetInstrumentation {
 							IARG_END);
 			RTN_Close(rtn);
 			SET_ACCESS_INSTRUMENTATION_STATUS(true)
-			return;
 		}
 
-		if (rtnName.find("disable_global_injection") != std::string::npos) {
+		rtn = markers[Marker::DisableGlobalInjection];
+		if (RTN_Valid(rtn)) {
 			RTN_Open(rtn);
 			RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::disable_global_injection,  
-							IF_PIN_LOCKED_COMMA(IARG_THREAD_ID)
+							IARG_THREAD_CONTROL
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 1,
 							IARG_FUNCARG_ENTRYPOINT_VALUE, 2,
@@ -663,11 +1760,11 @@ namespace TargetInstrumentation {
 							IARG_END);
 			RTN_Close(rtn);
 			SET_ACCESS_INSTRUMENTATION_STATUS(true)
-			return;
 		}
 
 		#if NARROW_ACCESS_INSTRUMENTATION
-			if (rtnName.find("disable_access_instrumentation") != std::string::npos) {
+			rtn = markers[Marker::DisableAccessInstrumentation];
+			if (RTN_Valid(rtn)) {
 				RTN_Open(rtn);
 				RTN_InsertCall(	rtn, IPOINT_BEFORE, (AFUNPTR)PintoolControl::disable_access_instrumentation,  
 								IARG_FUNCARG_ENTRYPOINT_VALUE, 0, 
@@ -679,14 +1776,26 @@ namespace TargetInstrumentation {
 								IARG_FUNCARG_ENTRYPOINT_VALUE, 6, 
 								IARG_END);
 				RTN_Close(rtn);
-				return;
 			}
 
-			if (rtnName.find("enable_access_instrumentation") != std::string::npos) {
+			rtn = markers[Marker::EnableAccessInstrumentation];
+			if (RTN_Valid(rtn)) {
 				SET_ACCESS_INSTRUMENTATION_STATUS(true)
-				return;
 			}
 		#endif
+
+		#if BULK_OPERATION_INTERCEPTION
+			TargetInstrumentation::BulkOperations::InterceptRoutines(img);
+		#endif
+	}
+
+	//what is kept by routine address must not outlive the image, or a later image loaded at the same addresses would get its decisions
+	VOID ImageUnload(const IMG img, VOID* v) {
+		InstrumentationFilter::ForgetImage(img);
+
+		#if BULK_OPERATION_INTERCEPTION
+			TargetInstrumentation::BulkOperations::ForgetRoutines(img);
+		#endif
 	}
 }
 
@@ -694,6 +1803,18 @@ namespace PintoolOutput {
 	std::ofstream accessLog;
 	std::ofstream energyConsumptionLog;
 
+	#if SELF_PROFILING
+		std::ofstream selfProfilingLog;
+	#endif
+
+	#if INSTRUCTION_ATTRIBUTION
+		std::ofstream instructionAttributionLog;
+	#endif
+
+	#if ACCESS_HEATMAP
+		std::ofstream heatmapLog;
+	#endif
+
 	void PrintEnabledOrDisabled(const char* const message, const bool enabled) {
 		std::cout << "\t" << message << ": ";
 		if (enabled) {
@@ -736,6 +1857,21 @@ namespace PintoolOutput {
 		PintoolOutput::PrintEnabledOrDisabled("Overcharge flip-back", OVERCHARGE_FLIP_BACK);
 		PintoolOutput::PrintEnabledOrDisabled("Least significant bits dropping", LS_BIT_DROPPING);
 		PintoolOutput::PrintEnabledOrDisabled("Multithreading support: shared buffer list, thread-level control", PIN_LOCKED);
+		PintoolOutput::PrintEnabledOrDisabled("Period sampling", PERIOD_SAMPLING);
+		PintoolOutput::PrintEnabledOrDisabled("Self-profiling", SELF_PROFILING);
+		PintoolOutput::PrintEnabledOrDisabled("Analytic error expectation (no actual injection)", ANALYTIC_ERROR_EXPECTATION);
+		PintoolOutput::PrintEnabledOrDisabled("Live statistics", LIVE_STATISTICS);
+		PintoolOutput::PrintEnabledOrDisabled("Stack access elision", STACK_ACCESS_ELISION);
+		PintoolOutput::PrintEnabledOrDisabled("Adaptive instrumentation", ADAPTIVE_INSTRUMENTATION);
+		PintoolOutput::PrintEnabledOrDisabled("REP string range access", REP_STRING_RANGE_ACCESS);
+		PintoolOutput::PrintEnabledOrDisabled("Bulk operation interception", BULK_OPERATION_INTERCEPTION);
+		PintoolOutput::PrintEnabledOrDisabled("Shadow memory lookup", SHADOW_MEMORY_LOOKUP);
+		PintoolOutput::PrintEnabledOrDisabled("Lazy period advancement", LAZY_PERIOD_ADVANCEMENT);
+		PintoolOutput::PrintEnabledOrDisabled("Fault event trace", FAULT_EVENT_TRACE);
+		PintoolOutput::PrintEnabledOrDisabled("Instruction attribution", INSTRUCTION_ATTRIBUTION);
+		PintoolOutput::PrintEnabledOrDisabled("Access heatmap", ACCESS_HEATMAP);
+		PintoolOutput::PrintEnabledOrDisabled("Persistent counters", PERSISTENT_COUNTERS);
+		PintoolOutput::PrintEnabledOrDisabled("Parallel log writing", PARALLEL_LOG_WRITING);
 
 		std::cout << std::string(50, '#') << std::endl;
 	}
@@ -770,18 +1906,152 @@ namespace PintoolOutput {
 		}
 	}
 
+	const ConsumptionProfile& GetConsumptionProfile(const ApproximateBuffer& approxBuffer) {
+		const ConsumptionProfileMap::const_iterator profileIt = g_consumptionProfiles.find(approxBuffer.GetConfigurationId());
+
+		if (profileIt == g_consumptionProfiles.cend()) {
+			std::cerr << "ApproxSS Error: somehow, Consumption Profile not informed." << std::endl;
+			PIN_ExitProcess(EXIT_FAILURE);
+		}
+
+		return *(profileIt->second.get());
+	}
+
+	#if PARALLEL_LOG_WRITING
+		class BufferAccessTotals {
+			public:
+				std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> m_accessesBytes{};
+				std::array<ErrorCount, ErrorCategory::Size> m_injections{};
+				#if PERIOD_SAMPLING
+					SampledBytes m_sampledBytes{};
+				#endif
+		};
+
+		std::vector<ChosenTermApproximateBuffer const *> GetBuffersInLogOrder() {
+			std::vector<ChosenTermApproximateBuffer const *> buffers;
+			buffers.reserve(PintoolControl::generalBuffers.size());
+
+			for (const auto& [_, approxBuffer] : PintoolControl::generalBuffers) {
+				buffers.push_back(approxBuffer.get());
+			}
+
+			return buffers;
+		}
+
+		class FormattedLogs {
+			public:
+				std::vector<std::ostringstream> m_accessChunks;
+				std::vector<BufferAccessTotals> m_accessTotals;
+				std::vector<std::ostringstream> m_energyChunks;
+				std::vector<std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>> m_energies; //zeroed, each one only gets its buffer's energy
+				bool m_isFormatted = false;
+		};
+
+		FormattedLogs formattedLogs;
+
+		//registered with PIN_AddPrepareForFiniFunction, as the writer threads can only run until then (called by Fini itself if Pin did not)
+		//the active buffers are retired first, as the thread control destructors do in Fini, so the chunks hold every period. g_pinLock is only released in Fini, so the target threads still running cannot change the buffers afterwards
+		VOID FormatLogs(VOID* v) {
+			IF_PIN_LOCKED(PIN_GetLock(&g_pinLock, -1);)
+
+			#if PIN_LOCKED
+				PIN_GetLock(&PintoolControl::tcMap_lock, -1);
+				for (const auto& [_, tdata] : PintoolControl::threadControlMap) {
+					tdata->RetireActiveBuffers();
+				}
+				PIN_ReleaseLock(&PintoolControl::tcMap_lock);
+			#else
+				PintoolControl::g_mainThreadControl.RetireActiveBuffers();
+			#endif
+
+			FormattedLogs& logs = PintoolOutput::formattedLogs;
+			const std::vector<ChosenTermApproximateBuffer const *> buffers = PintoolOutput::GetBuffersInLogOrder();
+
+			#if !ANALYTIC_ERROR_EXPECTATION
+				const size_t accessChunkCount = buffers.size();
+			#else
+				const size_t accessChunkCount = 0; //expected error counts are floating point, so they are only added up in the serial order, see WriteAccessLog
+			#endif
+
+			const size_t energyChunkCount = g_consumptionProfiles.empty() ? 0 : buffers.size();
+
+			logs.m_accessChunks.resize(accessChunkCount);
+			logs.m_accessTotals.resize(accessChunkCount);
+			for (std::ostringstream& chunk : logs.m_accessChunks) {
+				chunk.copyfmt(PintoolOutput::accessLog);
+			}
+
+			PintoolOutput::energyConsumptionLog.setf(std::ios::fixed);
+			PintoolOutput::energyConsumptionLog.precision(2);
+
+			std::vector<ConsumptionProfile const *> profiles(energyChunkCount);
+			for (size_t i = 0; i < energyChunkCount; ++i) {
+				profiles[i] = &PintoolOutput::GetConsumptionProfile(*buffers[i]);
+			}
+
+			logs.m_energyChunks.resize(energyChunkCount);
+			logs.m_energies.resize(energyChunkCount);
+			for (std::ostringstream& chunk : logs.m_energyChunks) {
+				chunk.copyfmt(PintoolOutput::energyConsumptionLog);
+			}
+
+			//both logs in a single round, as the writer threads exit after it
+			LogWriter::RunTasks(accessChunkCount + energyChunkCount, [&](const size_t i) {
+				#if !ANALYTIC_ERROR_EXPECTATION
+					if (i < accessChunkCount) {
+						BufferAccessTotals& totals = logs.m_accessTotals[i];
+						buffers[i]->WriteAccessLogToFile(logs.m_accessChunks[i], totals.m_accessesBytes, totals.m_injections IF_COMMA_PERIOD_SAMPLING(totals.m_sampledBytes));
+						return;
+					}
+				#endif
+
+				const size_t j = i - accessChunkCount;
+				buffers[j]->WriteEnergyLogToFile(logs.m_energyChunks[j], logs.m_energies[j], *profiles[j]);
+			});
+
+			logs.m_isFormatted = true;
+		}
+	#endif
+
 	VOID WriteAccessLog() {
 		PintoolOutput::accessLog << "Total Injection Calls: " << g_injectionCalls << std::endl;
 		
-		std::array<uint64_t, ErrorCategory::Size> totalTargetInjections;
+		std::array<ErrorCount, ErrorCategory::Size> totalTargetInjections;
 		std::fill_n(totalTargetInjections.data(), ErrorCategory::Size, 0);
 
 		std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> totalTargetAccessesBytes;
 		std::fill_n(&(totalTargetAccessesBytes[0][0]), AccessPrecision::Size * AccessTypes::Size, 0);
 
-		for (const auto& [_, approxBuffer] : PintoolControl::generalBuffers) { 
-			approxBuffer->WriteAccessLogToFile(PintoolOutput::accessLog, totalTargetAccessesBytes, totalTargetInjections);
-		}
+		#if PERIOD_SAMPLING
+			SampledBytes totalTargetSampledBytes;
+			std::fill_n(totalTargetSampledBytes.data(), AccessTypes::Size, 0);
+		#endif
+
+		#if PARALLEL_LOG_WRITING && !ANALYTIC_ERROR_EXPECTATION //expected error counts are floating point, so they are only added up in the serial order
+			//each buffer summed into its own totals (see FormatLogs), added to the target ones in the buffer order (integer sums, the same as the serial ones)
+			const std::vector<BufferAccessTotals>& bufferTotals = PintoolOutput::formattedLogs.m_accessTotals;
+
+			LogWriter::WriteChunks(PintoolOutput::accessLog, PintoolOutput::formattedLogs.m_accessChunks, 
+				[&](const size_t i) {
+					for (size_t j = 0; j < AccessPrecision::Size; ++j) {
+						for (size_t k = 0; k < AccessTypes::Size; ++k) {
+							totalTargetAccessesBytes[j][k] += bufferTotals[i].m_accessesBytes[j][k];
+						}
+					}
+					for (size_t j = 0; j < ErrorCategory::Size; ++j) {
+						totalTargetInjections[j] += bufferTotals[i].m_injections[j];
+					}
+					#if PERIOD_SAMPLING
+						for (size_t j = 0; j < AccessTypes::Size; ++j) {
+							totalTargetSampledBytes[j] += bufferTotals[i].m_sampledBytes[j];
+						}
+					#endif
+				});
+		#else
+			for (const auto& [_, approxBuffer] : PintoolControl::generalBuffers) { 
+				approxBuffer->WriteAccessLogToFile(PintoolOutput::accessLog, totalTargetAccessesBytes, totalTargetInjections IF_COMMA_PERIOD_SAMPLING(totalTargetSampledBytes));
+			}
+		#endif
 
 		uint64_t totalAccesses = 0;
 		PintoolOutput::accessLog << std::endl;
@@ -794,7 +2064,7 @@ namespace PintoolOutput {
 		PintoolOutput::accessLog << "Total Software Implementation Accessed Bytes/Bits: " << totalAccesses << " / " << (totalAccesses * BYTE_SIZE) << std::endl;
 
 		#if LOG_FAULTS
-			uint64_t totalInjections = 0;
+			ErrorCount totalInjections = 0;
 			PintoolOutput::accessLog << std::endl;
 
 			for (size_t i = 0; i < ErrorCategory::Size; ++i) {
@@ -806,6 +2076,13 @@ namespace PintoolOutput {
 			}
 
 			PintoolOutput::accessLog << "Total Errors Injected: " << (totalInjections) << std::endl;
+
+			#if PERIOD_SAMPLING
+				PintoolOutput::accessLog << std::endl;
+				for (size_t i = 0; i < AccessTypes::Size; ++i) {
+					WriteExtrapolatedInjectionsToFile(PintoolOutput::accessLog, ErrorCategoryNames[i], totalTargetInjections[i], totalTargetAccessesBytes[AccessPrecision::Approximate][i], totalTargetSampledBytes[i]);
+				}
+			#endif
 		#endif
 		
 		PintoolOutput::accessLog.close();
@@ -818,19 +2095,17 @@ namespace PintoolOutput {
 		PintoolOutput::energyConsumptionLog.setf(std::ios::fixed);
 		PintoolOutput::energyConsumptionLog.precision(2);
 
-		for (const auto& [_, approxBuffer] : PintoolControl::generalBuffers) { 
-			const int64_t configurationId = approxBuffer->GetConfigurationId();
-			const ConsumptionProfileMap::const_iterator profileIt = g_consumptionProfiles.find(configurationId);
-
-			if (profileIt == g_consumptionProfiles.cend()) {
-				std::cerr << "ApproxSS Error: somehow, Consumption Profile not informed." << std::endl;
-				PIN_ExitProcess(EXIT_FAILURE);
+		#if PARALLEL_LOG_WRITING
+			//each buffer's energy was added to a zeroed array (see FormatLogs), which holds it unchanged, and then to the target total in the buffer order (the same sums as the serial ones)
+			LogWriter::WriteChunks(PintoolOutput::energyConsumptionLog, PintoolOutput::formattedLogs.m_energyChunks, 
+				[&](const size_t i) {
+					AddEnergyConsumption(totalTargetEnergy, PintoolOutput::formattedLogs.m_energies[i]);
+				});
+		#else
+			for (const auto& [_, approxBuffer] : PintoolControl::generalBuffers) { 
+				approxBuffer->WriteEnergyLogToFile(PintoolOutput::energyConsumptionLog, totalTargetEnergy, PintoolOutput::GetConsumptionProfile(*approxBuffer));
 			}
-
-			const ConsumptionProfile& respectiveConsumptionProfile = *(profileIt->second.get());
-
-			approxBuffer->WriteEnergyLogToFile(PintoolOutput::energyConsumptionLog, totalTargetEnergy, respectiveConsumptionProfile);
-		}
+		#endif
 
 		PintoolOutput::energyConsumptionLog << std::endl << "TARGET APPLICATION TOTAL ENERGY CONSUMPTION" << std::endl;
 		WriteEnergyConsumptionToLogFile(PintoolOutput::energyConsumptionLog, totalTargetEnergy, false, false, "	");
@@ -840,6 +2115,14 @@ namespace PintoolOutput {
 	}
 
 	VOID Fini(const INT32 code, VOID* v) {
+		#if PARALLEL_LOG_WRITING
+			if (!PintoolOutput::formattedLogs.m_isFormatted) {
+				PintoolOutput::FormatLogs(nullptr);
+			}
+
+			IF_PIN_LOCKED(PIN_ReleaseLock(&g_pinLock);) //taken by FormatLogs, no target thread is left to wait on it
+		#endif
+
 		#if PIN_LOCKED
 			for (const auto& [_, tdata] : PintoolControl::threadControlMap) {
 				tdata->~ThreadControl();
@@ -854,6 +2137,43 @@ namespace PintoolOutput {
 			PintoolOutput::WriteEnergyLog();
 		}
 
+		#if SELF_PROFILING
+			SelfProfiler::WriteReportToFile(PintoolOutput::selfProfilingLog);
+			PintoolOutput::selfProfilingLog.close();
+		#endif
+
+		#if INSTRUCTION_ATTRIBUTION
+			InstructionAttribution::WriteReportToFile(PintoolOutput::instructionAttributionLog);
+			PintoolOutput::instructionAttributionLog.close();
+		#endif
+
+		#if ACCESS_HEATMAP
+			//retired buffers are still in generalBuffers, so every buffer of the run is reported
+			AccessHeatmap::WriteHeaderToFile(PintoolOutput::heatmapLog);
+			for (const auto& [_, approxBuffer] : PintoolControl::generalBuffers) {
+				approxBuffer->WriteHeatmapToFile(PintoolOutput::heatmapLog);
+			}
+			PintoolOutput::heatmapLog.close();
+		#endif
+
+		InstrumentationFilter::WriteExcludedAccessWarnings();
+
+		#if ADAPTIVE_INSTRUMENTATION
+			AdaptiveInstrumentation::PrintSummary();
+		#endif
+
+		#if LIVE_STATISTICS
+			LiveStatistics::Finish(); //after the destructors above, so that the errors of the still active periods are in
+		#endif
+
+		#if FAULT_EVENT_TRACE
+			FaultTrace::Finish(); //after the destructors above, which may still inject the pending write and passive errors
+		#endif
+
+		#if PERSISTENT_COUNTERS
+			PersistentCounters::Finish(); //after the destructors above, which store the last period logs, and before the buffers are deleted
+		#endif
+
 		PintoolOutput::DeleteDataEstructures();
 	}
 }
@@ -877,6 +2197,52 @@ KNOB<std::string> EnergyProfileFile(KNOB_MODE_WRITEONCE, "pintool", "pfl", "", "
 KNOB<std::string> AccessOutputFile(KNOB_MODE_WRITEONCE, "pintool", "aof", "", "specify the memory access output log");
 KNOB<std::string> EnergyConsumptionOutputFile(KNOB_MODE_WRITEONCE, "pintool", "cof", "", "specify the energy consumpion output log");
 
+KNOB<std::string> InstrumentedImages(KNOB_MODE_APPEND, "pintool", "aii", "", "restrict memory access instrumentation to images matching the given name or glob (may be repeated)");
+KNOB<std::string> InstrumentedRoutines(KNOB_MODE_APPEND, "pintool", "air", "", "restrict memory access instrumentation to routines matching the given name or glob (may be repeated)");
+KNOB<BOOL> WarnExcludedAccesses(KNOB_MODE_WRITEONCE, "pintool", "aiw", "0", "report accesses to approximate buffers made by code excluded from memory access instrumentation (profiling runs)");
+
+#if SELF_PROFILING
+	KNOB<std::string> SelfProfilingOutputFile(KNOB_MODE_WRITEONCE, "pintool", "sof", "", "specify the self-profiling output report (csv)");
+#endif
+
+#if LIVE_STATISTICS
+	KNOB<std::string> LiveStatisticsName(KNOB_MODE_WRITEONCE, "pintool", "lsn", "", "specify the live statistics shared-memory segment name (/dev/shm/<name>, default: approxss_<pid>)");
+	KNOB<UINT32> LiveStatisticsInterval(KNOB_MODE_WRITEONCE, "pintool", "lsi", "1000", "specify the live statistics publication interval (ms)");
+#endif
+
+#if INSTRUCTION_ATTRIBUTION
+	KNOB<std::string> InstructionAttributionOutputFile(KNOB_MODE_WRITEONCE, "pintool", "iaf", "", "specify the instruction attribution output report (csv)");
+#endif
+
+#if PERSISTENT_COUNTERS
+	KNOB<std::string> PersistentCountersFile(KNOB_MODE_WRITEONCE, "pintool", "pcf", "", "specify the persistent counters output file (binary, memory-mapped)");
+	KNOB<UINT64> PersistentCountersCapacity(KNOB_MODE_WRITEONCE, "pintool", "pcc", "1024", "specify the persistent counters file capacity (MiB), later records are only kept in memory");
+#endif
+
+#if PARALLEL_LOG_WRITING
+	KNOB<UINT32> LogWriterThreads(KNOB_MODE_WRITEONCE, "pintool", "lwt", "4", "specify how many threads format the access and energy logs at the end of the execution");
+#endif
+
+#if ACCESS_HEATMAP
+	KNOB<std::string> HeatmapOutputFile(KNOB_MODE_WRITEONCE, "pintool", "hmf", "", "specify the access heatmap output report (csv)");
+	KNOB<UINT64> HeatmapBlockSize(KNOB_MODE_WRITEONCE, "pintool", "hmb", "4096", "specify the access heatmap block size (bytes, power of two)");
+	KNOB<UINT64> HeatmapSamplingInterval(KNOB_MODE_WRITEONCE, "pintool", "hms", "1", "record only every k-th access of each buffer in the access heatmap (scaled by k)");
+#endif
+
+#if FAULT_EVENT_TRACE
+	KNOB<std::string> FaultTraceOutputFile(KNOB_MODE_WRITEONCE, "pintool", "fet", "", "specify the fault event trace output file (binary)");
+	KNOB<UINT64> FaultTraceCap(KNOB_MODE_WRITEONCE, "pintool", "fec", "1024", "specify the fault event trace size cap (MiB), later events are only counted as dropped");
+#endif
+
+#if ADAPTIVE_INSTRUMENTATION
+	KNOB<UINT64> AdaptiveWarmUp(KNOB_MODE_WRITEONCE, "pintool", "awu", "10000", "specify how many executions without hitting approximate buffers an instruction takes to be left uninstrumented");
+#endif
+
+#if PERIOD_SAMPLING
+	KNOB<UINT64> PeriodSamplingInterval(KNOB_MODE_WRITEONCE, "pintool", "spi", "1", "inject only in every k-th period (systematic period sampling)");
+	KNOB<double> PeriodSamplingRate(KNOB_MODE_WRITEONCE, "pintool", "spr", "1.0", "inject only in periods randomly sampled with the given probability (random period sampling)");
+#endif
+
 /* ==================================================================== */
 /* Main																	*/
 /* ==================================================================== */
@@ -890,7 +2256,36 @@ int main(const int argc, char* argv[]) {
 	if (PIN_Init(argc, argv)) return Usage();
 
 	PintoolOutput::PrintPintoolConfiguration();
+
+	#if PERIOD_SAMPLING
+		PintoolControl::ConfigurePeriodSampling(PeriodSamplingInterval.Value(), PeriodSamplingRate.Value());
+	#endif
+
+	for (UINT32 i = 0; i < InstrumentedImages.NumberOfValues(); ++i) {
+		InstrumentationFilter::AddImagePattern(InstrumentedImages.Value(i));
+	}
+	for (UINT32 i = 0; i < InstrumentedRoutines.NumberOfValues(); ++i) {
+		InstrumentationFilter::AddRoutinePattern(InstrumentedRoutines.Value(i));
+	}
+	InstrumentationFilter::SetWarnExcludedAccesses(WarnExcludedAccesses.Value());
+
 	PintoolInput::ProcessInjectorConfiguration(InjectorConfigurationFile.Value());
+	InstrumentationFilter::PrintConfiguration();
+
+	#if STACK_ACCESS_ELISION
+		PintoolControl::ConfigureStackAccessElision();
+		PIN_AddThreadStartFunction(PintoolControl::RecordThreadStack, nullptr);
+		PIN_AddThreadFiniFunction(PintoolControl::ForgetThreadStack, nullptr);
+	#endif
+
+	#if ADAPTIVE_INSTRUMENTATION
+		AdaptiveInstrumentation::ConfigureWarmUp(AdaptiveWarmUp.Value());
+	#endif
+
+	#if SHADOW_MEMORY_LOOKUP
+		ShadowMemory::Initialize();
+	#endif
+
 	PintoolOutput::CreateOutputLog(PintoolOutput::accessLog, AccessOutputFile.Value(), "access.log");
 
 	PintoolInput::ProcessEnergyProfile(EnergyProfileFile.Value());
@@ -899,14 +2294,41 @@ int main(const int argc, char* argv[]) {
 		PintoolOutput::CreateOutputLog(PintoolOutput::energyConsumptionLog, EnergyConsumptionOutputFile.Value(), "energyConsumpion.log");
 	}
 
-	// Register Routine to be called to instrument rtn
-	RTN_AddInstrumentFunction(TargetInstrumentation::Routine, nullptr);
+	#if SELF_PROFILING
+		PintoolOutput::CreateOutputLog(PintoolOutput::selfProfilingLog, SelfProfilingOutputFile.Value(), "selfProfiling.csv");
+	#endif
+
+	#if INSTRUCTION_ATTRIBUTION
+		PintoolOutput::CreateOutputLog(PintoolOutput::instructionAttributionLog, InstructionAttributionOutputFile.Value(), "instructionAttribution.csv");
+	#endif
+
+	#if PERSISTENT_COUNTERS
+		PersistentCounters::Initialize(PersistentCountersFile.Value().empty() ? PintoolOutput::GenerateTimeDependentFileName("persistentCounters.bin") : PersistentCountersFile.Value(), PersistentCountersCapacity.Value());
+	#endif
+
+	#if PARALLEL_LOG_WRITING
+		LogWriter::StartWorkers(LogWriterThreads.Value());
+		PIN_AddPrepareForFiniFunction(PintoolOutput::FormatLogs, nullptr);
+	#endif
+
+	#if ACCESS_HEATMAP
+		AccessHeatmap::Configure(HeatmapBlockSize.Value(), HeatmapSamplingInterval.Value());
+		PintoolOutput::CreateOutputLog(PintoolOutput::heatmapLog, HeatmapOutputFile.Value(), "accessHeatmap.csv");
+	#endif
+
+	#if FAULT_EVENT_TRACE
+		FaultTrace::Initialize(FaultTraceOutputFile.Value().empty() ? PintoolOutput::GenerateTimeDependentFileName("faultTrace.bin") : FaultTraceOutputFile.Value(), FaultTraceCap.Value());
+	#endif
+
+	// Register Image to be called to find and instrument the markers of each loaded image (and ImageUnload to forget its routines)
+	IMG_AddInstrumentFunction(TargetInstrumentation::Image, nullptr);
+	IMG_AddUnloadFunction(TargetInstrumentation::ImageUnload, nullptr);
 
-	// Obtain  a key for TLS storage.
+	// Claim a tool register to keep each thread's control
 	#if PIN_LOCKED
-		g_tlsKey = PIN_CreateThreadDataKey(nullptr);
-		if (g_tlsKey == INVALID_TLS_KEY)    {
-			std::cerr << "Pin Error: number of already allocated keys reached the MAX_CLIENT_TLS_KEYS limit" << std::endl;
+		g_threadControlReg = PIN_ClaimToolRegister();
+		if (!REG_valid(g_threadControlReg)) {
+			std::cerr << "Pin Error: no tool register available to keep the thread control" << std::endl;
 			PIN_ExitProcess(EXIT_FAILURE);
 		}
 
@@ -921,6 +2343,12 @@ int main(const int argc, char* argv[]) {
 
 	PIN_AddFiniFunction(PintoolOutput::Fini, nullptr);
 
+	#if LIVE_STATISTICS
+		LiveStatistics::Initialize(LiveStatisticsName.Value(), LiveStatisticsInterval.Value());
+		PIN_AddPrepareForFiniFunction(LiveStatistics::StopPublisher, nullptr);
+		LiveStatistics::StartPublisher();
+	#endif
+
 	// Never returns
 	PIN_StartProgram();
 	
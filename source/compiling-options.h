@@ -65,6 +65,86 @@ constexpr size_t BYTE_SIZE = 8;
 	#define PIN_LOCKED false
 #endif
 
+#ifndef ANALYTIC_ERROR_EXPECTATION //NOTE: NO ERRORS ARE ACTUALLY INJECTED, THE LOGS REPORT EXPECTED ERROR COUNTS INSTEAD
+	#define ANALYTIC_ERROR_EXPECTATION false
+#endif
+
+#ifndef SELF_PROFILING //NOTE: MEASURES APPROXSS ITSELF, TIMERS ADD SOME OVERHEAD OF THEIR OWN
+	#define SELF_PROFILING false
+#endif
+
+#ifndef PERIOD_SAMPLING //NOTE: INJECTION ONLY HAPPENS IN SAMPLED PERIODS, FAULT COUNTS ARE EXTRAPOLATED FROM THEM
+	#define PERIOD_SAMPLING false
+#endif
+
+#ifndef LIVE_STATISTICS //NOTE: PUBLISHES RUNNING TOTALS TO A SHARED-MEMORY REGION, READ BY live_statistics_reader/
+	#define LIVE_STATISTICS false
+#endif
+
+#ifndef STACK_ACCESS_ELISION //NOTE: STACK ACCESSES ARE ONLY INSTRUMENTED AFTER SOME APPROXIMATE BUFFER IS FOUND ON THE STACK
+	#define STACK_ACCESS_ELISION true
+#endif
+
+#ifndef ADAPTIVE_INSTRUMENTATION //NOTE: INSTRUCTIONS THAT NEVER HIT APPROXIMATE BUFFERS DURING A WARM-UP LOSE THEIR ANALYSIS CALLS UNTIL THE NEXT add_approx()
+	#define ADAPTIVE_INSTRUMENTATION false
+#endif
+
+#ifndef THREAD_PRIVATE_ACCESS_COUNTING //NOTE: ACCESSES ARE COUNTED IN THREAD-PRIVATE SLOTS AND ONLY MERGED INTO THE PERIOD LOG WHEN THE PERIOD IS STORED
+	#define THREAD_PRIVATE_ACCESS_COUNTING (PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS && true)
+#endif
+
+#ifndef REP_STRING_RANGE_ACCESS //NOTE: REP MOVS/STOS ARE HANDLED ONCE PER INSTRUCTION, AS A SINGLE RANGE, INSTEAD OF ONCE PER ITERATION
+	#define REP_STRING_RANGE_ACCESS true
+#endif
+
+#ifndef BULK_OPERATION_INTERCEPTION //NOTE: memcpy/memmove/memset CALLS ARE HANDLED AT ROUTINE ENTRY, THE INSTRUCTIONS INSIDE THEM ARE NOT INSTRUMENTED
+	#define BULK_OPERATION_INTERCEPTION false
+#endif
+
+#ifndef LAZY_PERIOD_ADVANCEMENT //NOTE: next_period() ONLY MOVES THE GLOBAL PERIOD, EACH BUFFER CATCHES UP ON ITS NEXT ACCESS OR AT ITS RETIREMENT
+	#define LAZY_PERIOD_ADVANCEMENT false
+#endif
+
+#ifndef BULK_RANGE_INJECTION //NOTE: RANGES OF ELEMENTS GET THEIR FAULT COUNTS FROM A BINOMIAL DRAW INSTEAD OF ONE DRAW PER BIT OF EACH ELEMENT (SAME DISTRIBUTION, DIFFERENT RANDOM SEQUENCE)
+	#define BULK_RANGE_INJECTION true
+#endif
+
+#ifndef BIT_DEPTH_KERNELS //NOTE: COMMON BIT DEPTHS (8, 16, 23, 32, 52, 64) ARE INJECTED BY KERNELS SPECIALIZED ON THE DEPTH, SELECTED ONCE PER FAULT INJECTOR
+	#define BIT_DEPTH_KERNELS true
+#endif
+
+#ifndef BER_SCHEDULE //NOTE: BERS ARE COMPILED AT LOAD TIME INTO INTEGER THRESHOLDS AND CUMULATIVE PER-BIT TABLES, INJECTION DRAWS RAW 64-BIT NUMBERS (DIFFERENT RANDOM SEQUENCE)
+	#define BER_SCHEDULE (!DISTANCE_BASED_FAULT_INJECTOR && !OVERCHARGE_BER && false)
+#endif
+
+#ifndef BATCHED_DISTANCE_SAMPLING //NOTE: ERROR DISTANCES OF THE DISTANCE_BASED_FAULT_INJECTOR ARE GENERATED IN BLOCKS OF 256 PER RECORD (BOX-MULLER, DIFFERENT RANDOM SEQUENCE)
+	#define BATCHED_DISTANCE_SAMPLING (DISTANCE_BASED_FAULT_INJECTOR && true)
+#endif
+
+#ifndef SHADOW_MEMORY_LOOKUP //NOTE: RESERVES (BUT DOES NOT COMMIT) 128 GiB OF ADDRESS SPACE FOR A PAGE-TO-BUFFER SHADOW MAP
+	#define SHADOW_MEMORY_LOOKUP (MULTIPLE_ACTIVE_BUFFERS && false)
+#endif
+
+#ifndef FAULT_EVENT_TRACE //NOTE: WRITES EVERY INJECTED FAULT TO A BINARY TRACE FILE, READ BY fault_trace_reader/
+	#define FAULT_EVENT_TRACE false
+#endif
+
+#ifndef INSTRUCTION_ATTRIBUTION //NOTE: COUNTS APPROXIMATE BYTES AND INJECTED FAULTS PER INSTRUCTION ADDRESS, REPORTED AT THE END
+	#define INSTRUCTION_ATTRIBUTION false
+#endif
+
+#ifndef ACCESS_HEATMAP //NOTE: SAMPLED ACCESSED BYTES AND INJECTED FAULTS OVER FIXED-SIZE BLOCKS OF EACH BUFFER, REPORTED AT THE END
+	#define ACCESS_HEATMAP false
+#endif
+
+#ifndef PERSISTENT_COUNTERS //NOTE: PERIOD LOG COUNTERS LIVE IN A FILE-BACKED MAPPING, SO THEY SURVIVE TARGET CRASHES, READ BY persistent_counters_reader/
+	#define PERSISTENT_COUNTERS false
+#endif
+
+#ifndef PARALLEL_LOG_WRITING //NOTE: THE PER-BUFFER ACCESS AND ENERGY LOGS ARE FORMATTED BY INTERNAL THREADS AT THE END, SAME OUTPUT
+	#define PARALLEL_LOG_WRITING false
+#endif
+
 //USER-DEFINED END
 
 #if PIN_LOCKED
@@ -79,6 +159,98 @@ constexpr size_t BYTE_SIZE = 8;
 
 #define IF_PIN_PRIVATE_LOCKED(X)
 
+#define RANGE_ACCESS_HANDLING (REP_STRING_RANGE_ACCESS || BULK_OPERATION_INTERCEPTION)
+
+#if PERIOD_SAMPLING
+	#define IF_PERIOD_SAMPLING(X) X
+	#define IF_COMMA_PERIOD_SAMPLING(X) ,X
+#else
+	#define IF_PERIOD_SAMPLING(X)
+	#define IF_COMMA_PERIOD_SAMPLING(X)
+#endif
+
+#if BATCHED_DISTANCE_SAMPLING
+	#define IF_BATCHED_DISTANCE_SAMPLING(X) X
+	#define IF_COMMA_BATCHED_DISTANCE_SAMPLING(X) ,X
+#else
+	#define IF_BATCHED_DISTANCE_SAMPLING(X)
+	#define IF_COMMA_BATCHED_DISTANCE_SAMPLING(X)
+#endif
+
+#if PERSISTENT_COUNTERS
+	#define IF_PERSISTENT_COUNTERS(X) X
+	#define IF_COMMA_PERSISTENT_COUNTERS(X) ,X
+#else
+	#define IF_PERSISTENT_COUNTERS(X)
+	#define IF_COMMA_PERSISTENT_COUNTERS(X)
+#endif
+
+#if ACCESS_HEATMAP
+	#define IF_ACCESS_HEATMAP(X) X
+#else
+	#define IF_ACCESS_HEATMAP(X)
+#endif
+
+//the buffer tells which of its faults are about to be injected, for the options that record each fault
+#if FAULT_EVENT_TRACE || ACCESS_HEATMAP
+	#define INJECTION_CONTEXT true
+	#define IF_INJECTION_CONTEXT(X) X
+#else
+	#define INJECTION_CONTEXT false
+	#define IF_INJECTION_CONTEXT(X)
+#endif
+
+#if STACK_ACCESS_ELISION
+	#define IF_COMMA_STACK_ACCESS_ELISION(X) ,X
+#else
+	#define IF_COMMA_STACK_ACCESS_ELISION(X)
+#endif
+
+#if THREAD_PRIVATE_ACCESS_COUNTING
+	#define IF_THREAD_PRIVATE_ACCESS_COUNTING(X) X
+	#define IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(X) ,X
+#else
+	#define IF_THREAD_PRIVATE_ACCESS_COUNTING(X)
+	#define IF_COMMA_THREAD_PRIVATE_ACCESS_COUNTING(X)
+#endif
+
+#if MULTIPLE_ACTIVE_BUFFERS
+	#define IF_COMMA_MULTIPLE_ACTIVE_BUFFERS(X) ,X
+#else
+	#define IF_COMMA_MULTIPLE_ACTIVE_BUFFERS(X)
+#endif
+
+#if ADAPTIVE_INSTRUMENTATION
+	#define IF_COMMA_ADAPTIVE_INSTRUMENTATION(X) ,X
+	#define IARG_ADAPTIVE_PROFILE(X) IARG_PTR, X,
+#else
+	#define IF_COMMA_ADAPTIVE_INSTRUMENTATION(X)
+	#define IARG_ADAPTIVE_PROFILE(X)
+#endif
+
+#if INSTRUCTION_ATTRIBUTION
+	#define IF_COMMA_INSTRUCTION_ATTRIBUTION(X) ,X
+	#define IARG_ATTRIBUTED_ADDRESS(X) X,
+#else
+	#define IF_COMMA_INSTRUCTION_ATTRIBUTION(X)
+	#define IARG_ATTRIBUTED_ADDRESS(X)
+#endif
+
+//the instruction address is passed to the access handlers if any of the options needs it
+#if ADAPTIVE_INSTRUMENTATION || INSTRUCTION_ATTRIBUTION
+	#define IF_COMMA_INSTRUCTION_ADDRESS(X) ,X
+	#define IARG_INSTRUCTION_ADDRESS IARG_INST_PTR,
+#else
+	#define IF_COMMA_INSTRUCTION_ADDRESS(X)
+	#define IARG_INSTRUCTION_ADDRESS
+#endif
+
+#if ANALYTIC_ERROR_EXPECTATION
+	#define IF_COMMA_ANALYTIC_ERROR_EXPECTATION(X) ,X
+#else
+	#define IF_COMMA_ANALYTIC_ERROR_EXPECTATION(X)
+#endif
+
 
 #if !DEFAULT_FAULT_INJECTOR && !GRANULAR_FAULT_INJECTOR && !DISTANCE_BASED_FAULT_INJECTOR
 #	error "ApproxSS compilation error: no fault injector defined!"
@@ -88,6 +260,30 @@ constexpr size_t BYTE_SIZE = 8;
 #	error "ApproxSS compilation error: no buffer term defined!"
 #endif
 
+#if THREAD_PRIVATE_ACCESS_COUNTING && !(PIN_LOCKED && MULTIPLE_ACTIVE_BUFFERS)
+#	error "ApproxSS compilation error: thread-private access counting requires PIN_LOCKED and MULTIPLE_ACTIVE_BUFFERS!"
+#endif
+
+#if SHADOW_MEMORY_LOOKUP && !MULTIPLE_ACTIVE_BUFFERS
+#	error "ApproxSS compilation error: shadow memory lookup requires MULTIPLE_ACTIVE_BUFFERS!"
+#endif
+
+#if LAZY_PERIOD_ADVANCEMENT && DISTANCE_BASED_FAULT_INJECTOR && ENABLE_PASSIVE_INJECTION && MULTIPLE_BER_CONFIGURATION
+#	error "ApproxSS compilation error: lazy period advancement is not compatible with distance-based passive injection under multiple BER configurations!"
+#endif
+
+#if BER_SCHEDULE && (DISTANCE_BASED_FAULT_INJECTOR || OVERCHARGE_BER)
+#	error "ApproxSS compilation error: BER schedules are not compatible with the distance-based injector nor with overcharged BERs!"
+#endif
+
+#if ANALYTIC_ERROR_EXPECTATION && !LOG_FAULTS
+#	error "ApproxSS compilation error: analytic error expectation requires fault logging!"
+#endif
+
+#if ANALYTIC_ERROR_EXPECTATION && PERIOD_SAMPLING
+#	error "ApproxSS compilation error: analytic error expectation is not compatible with period sampling!"
+#endif
+
 //AUXILIARY DATA STRUCTURES
 #include <string>
 #include <array>
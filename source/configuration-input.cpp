@@ -302,6 +302,9 @@ void PintoolInput::ProcessInjectorConfiguration(const std::string& configuration
 			const InjectorConfigurationMap::const_iterator lb = g_injectorConfigurations.lower_bound(injectorCfg->GetConfigurationId());
 
 			if (lb == g_injectorConfigurations.cend() || (g_injectorConfigurations.key_comp()(injectorCfg->GetConfigurationId(), lb->first))) {
+				#if BER_SCHEDULE
+					injectorCfg->CompileBerSchedules();
+				#endif
 				g_injectorConfigurations.emplace_hint(lb, injectorCfg->GetConfigurationId(), std::unique_ptr<InjectionConfigurationReference>(injectorCfg));
 			} else {
 				std::cout << "Warning: ConfigurationId already specified. Discarding and ignoring it. Line " << lineCount << std::endl;
@@ -359,6 +362,12 @@ void PintoolInput::ProcessInjectorConfiguration(const std::string& configuration
 					std::cout << "ApproxSS warning: Passive injection configuration detected, but not supported." << std::endl;
 				#endif
 				break;
+			case InjectorFieldCode::InstrumentImage: //not bound to the configuration being read
+				InstrumentationFilter::AddImagePattern(value);
+				break;
+			case InjectorFieldCode::InstrumentRoutine:
+				InstrumentationFilter::AddRoutinePattern(value);
+				break;
 			default:
 				std::cerr << ("ApproxSS Error: malformed configuration. Unrecognized field: \"" + field + "\". Line: " + std::to_string(lineCount) + ".") << std::endl;
 				PIN_ExitProcess(EXIT_FAILURE);
@@ -13,6 +13,7 @@
 #include "compiling-options.h"	
 #include "injector-configuration.h"
 #include "consumption-profile.h"
+#include "instrumentation-filter.h"
 
 enum class InjectorFieldCode {
 	ConfigurationId,
@@ -21,6 +22,8 @@ enum class InjectorFieldCode {
 	ReadBer,
 	WriteBer,
 	PassiveBer,
+	InstrumentImage,
+	InstrumentRoutine,
 	NOT_FOUND
 };
 
@@ -29,7 +32,9 @@ const std::unordered_map<InjectorFieldCode, const std::string> InjectorFieldCode
 																							{InjectorFieldCode::LSBDropped,			"LSBDropped"},
 																							{InjectorFieldCode::ReadBer,			"ReadBer"},
 																							{InjectorFieldCode::WriteBer,			"WriteBer"},
-																							{InjectorFieldCode::PassiveBer,			"PassiveBer"}};
+																							{InjectorFieldCode::PassiveBer,			"PassiveBer"},
+																							{InjectorFieldCode::InstrumentImage,	"InstrumentImage"},
+																							{InjectorFieldCode::InstrumentRoutine,	"InstrumentRoutine"}};
 
 
 struct ConsumptionFieldCode {
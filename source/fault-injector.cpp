@@ -1,19 +1,84 @@
 #include "fault-injector.h"
 
-std::default_random_engine FaultInjector::generator{std::random_device{}()};
+//every buffer is of the chosen (final) type, so the backup is a direct call instead of a virtual one
+static inline void BackupReadData(ApproximateBuffer* const toBackup, uint8_t* const data) {
+	static_cast<ChosenTermApproximateBuffer*>(toBackup)->BackupReadData(data);
+}
+
+RandomEngine FaultInjector::generator{std::random_device{}()};
 std::uniform_real_distribution<double> FaultInjector::occurrenceDistribution{0.0f, 1.0f};
 
-FaultInjector::FaultInjector(const InjectionConfigurationReference& injectorCfg) : InjectionConfigurationLocal(injectorCfg) {}
+FaultInjector::FaultInjector(const InjectionConfigurationReference& injectorCfg) : InjectionConfigurationLocal(injectorCfg) {
+	#if BIT_DEPTH_KERNELS
+		this->m_injectionKernel = FaultInjector::SelectInjectionKernel(this->GetBitDepth());
+	#endif
+}
+
+#if BIT_DEPTH_KERNELS
+	//smallest native word holding the element's bits
+	template <size_t BitDepth>
+	using InjectionWord = std::conditional_t<(BitDepth <= 8), uint8_t, std::conditional_t<(BitDepth <= 16), uint16_t, std::conditional_t<(BitDepth <= 32), uint32_t, uint64_t>>>;
+
+	//same draws, in the same order, as the generic loop, but the flips are gathered in a constant-width mask and applied with a single XOR
+	template <size_t BitDepth, typename BerType>
+	void FaultInjector::InjectFaultKernel(uint8_t* const data, const BerType ber, const size_t countStart, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
+		typedef InjectionWord<BitDepth> Word;
+		constexpr size_t touchedBytes = (BitDepth + BYTE_SIZE - 1) / BYTE_SIZE; //never past the element, even for depths like 23
+
+		Word faultMask = 0;
+
+		for (size_t bitCount = countStart; bitCount < BitDepth; ++bitCount) {
+			if (FaultInjector::occurrenceDistribution(FaultInjector::generator) < FaultInjector::GetBitBer(ber, bitCount)) {
+				faultMask |= static_cast<Word>(static_cast<Word>(FaultInjector::bitMask) << bitCount);
+				RECORD_FAULT(data, bitCount)
+
+				#if LOG_FAULTS
+					++injectedByBit[bitCount];
+				#endif
+			}
+		}
+
+		if (faultMask != 0) {
+			if (toBackup) {
+				BackupReadData(toBackup, data);
+			}
+
+			Word word = 0;
+			std::memcpy(&word, data, touchedBytes);
+			word ^= faultMask;
+			std::memcpy(data, &word, touchedBytes);
+		}
+	}
+
+	FaultInjector::InjectionKernel FaultInjector::SelectInjectionKernel(const size_t bitDepth) {
+		#if !MULTIPLE_BER_ELEMENT
+			typedef double BerType;
+		#else
+			typedef double const * BerType;
+		#endif
+
+		switch (bitDepth) {
+			case 8:		return &FaultInjector::InjectFaultKernel<8, BerType>;
+			case 16:	return &FaultInjector::InjectFaultKernel<16, BerType>;
+			case 23:	return &FaultInjector::InjectFaultKernel<23, BerType>;	//float mantissa
+			case 32:	return &FaultInjector::InjectFaultKernel<32, BerType>;
+			case 52:	return &FaultInjector::InjectFaultKernel<52, BerType>;	//double mantissa
+			case 64:	return &FaultInjector::InjectFaultKernel<64, BerType>;
+			default:	return nullptr;
+		}
+	}
+#endif
 
 #if !MULTIPLE_BER_ELEMENT
 	void FaultInjector::InjectFault(uint8_t* const data, const double ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
 		++g_injectionCalls;
+		PROFILE_SCOPE(InjectFault)
 		bool isFaultInjected = false;
 
 		#if LS_BIT_DROPPING
 			if (this->HasLSBDropping()) {
 				if (toBackup) {
-					toBackup->BackupReadData(data);
+					BackupReadData(toBackup, data);
 					isFaultInjected = true;
 				}
 
@@ -28,18 +93,26 @@ FaultInjector::FaultInjector(const InjectionConfigurationReference& injectorCfg)
 		#else
 			constexpr size_t countStart = 0;
 		#endif
+
+		#if BIT_DEPTH_KERNELS
+			if (this->m_injectionKernel) {
+				this->m_injectionKernel(data, ber, countStart, isFaultInjected ? nullptr : toBackup AND_LOG_ARGUMENT(injectedByBit));
+				return;
+			}
+		#endif
 		
 		for (size_t bitCount = countStart; bitCount < this->GetBitDepth(); ++bitCount) {
 			const double randomProbability = FaultInjector::occurrenceDistribution(FaultInjector::generator);
 
 			if (randomProbability < ber) {
 				if (toBackup && !isFaultInjected) {
-					toBackup->BackupReadData(data);
+					BackupReadData(toBackup, data);
 					isFaultInjected = true;
 				}
 
 				const uint8_t faultMask = FaultInjector::bitMask << (bitCount % BYTE_SIZE);
 				data[bitCount/BYTE_SIZE] ^= faultMask;
+				RECORD_FAULT(data, bitCount)
 
 				#if LOG_FAULTS
 					++injectedByBit[bitCount];
@@ -50,12 +123,13 @@ FaultInjector::FaultInjector(const InjectionConfigurationReference& injectorCfg)
 #else
 	void FaultInjector::InjectFault(uint8_t* const data, double const * const ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
 		++g_injectionCalls;
+		PROFILE_SCOPE(InjectFault)
 		bool isFaultInjected = false;
 
 		#if LS_BIT_DROPPING
 			if (this->HasLSBDropping()) {
 				if (toBackup) {
-					toBackup->BackupReadData(data);
+					BackupReadData(toBackup, data);
 					isFaultInjected = true;
 				}
 
@@ -70,18 +144,26 @@ FaultInjector::FaultInjector(const InjectionConfigurationReference& injectorCfg)
 		#else
 			constexpr size_t countStart = 0;
 		#endif
+
+		#if BIT_DEPTH_KERNELS
+			if (this->m_injectionKernel) {
+				this->m_injectionKernel(data, ber, countStart, isFaultInjected ? nullptr : toBackup AND_LOG_ARGUMENT(injectedByBit));
+				return;
+			}
+		#endif
 		
 		for (size_t bitCount = countStart; bitCount < this->GetBitDepth(); ++bitCount) {
 			const double randomProbability = FaultInjector::occurrenceDistribution(FaultInjector::generator);
 
 			if (randomProbability < ber[bitCount]) {
 				if (toBackup && !isFaultInjected) {
-					toBackup->BackupReadData(data);
+					BackupReadData(toBackup, data);
 					isFaultInjected = true;
 				}
 
 				const uint8_t faultMask = FaultInjector::bitMask << (bitCount % BYTE_SIZE);
 				data[bitCount/BYTE_SIZE] ^= faultMask;
+				RECORD_FAULT(data, bitCount)
 
 				#if LOG_FAULTS
 					++injectedByBit[bitCount];
@@ -91,6 +173,142 @@ FaultInjector::FaultInjector(const InjectionConfigurationReference& injectorCfg)
 	}
 #endif
 
+#if BER_SCHEDULE
+	void FaultInjector::InjectFault(uint8_t* const data, BerSchedule const * const schedule, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
+		++g_injectionCalls;
+		PROFILE_SCOPE(InjectFault)
+		bool isFaultInjected = false;
+
+		#if LS_BIT_DROPPING
+			if (this->HasLSBDropping()) {
+				if (toBackup) {
+					BackupReadData(toBackup, data);
+					isFaultInjected = true;
+				}
+
+				data[0] = data[0] & (FaultInjector::bitDroppingMask << this->GetLSBDropped()); //always sets first bit to zero
+			}
+		#endif
+
+		const uint64_t draw = FaultInjector::generator();
+		if (draw >= schedule->m_faultThreshold) {
+			return;
+		}
+
+		if (toBackup && !isFaultInjected) {
+			BackupReadData(toBackup, data);
+		}
+
+		//the first faulty bit comes from inverting the survival with the same draw, each next one from a fresh draw
+		double const * const logSurvival = schedule->m_logSurvival.get();
+		double survivalTarget = std::log1p(-BerSchedule::ToUnitInterval(draw));
+
+		for (size_t bitCount = schedule->m_countStart; bitCount < this->GetBitDepth(); ++bitCount) {
+			if (!(logSurvival[bitCount + 1] < survivalTarget)) {
+				continue;
+			}
+
+			data[bitCount/BYTE_SIZE] ^= (FaultInjector::bitMask << (bitCount % BYTE_SIZE));
+			RECORD_FAULT(data, bitCount)
+
+			#if LOG_FAULTS
+				++injectedByBit[bitCount];
+			#endif
+
+			survivalTarget = logSurvival[bitCount + 1] + std::log1p(-BerSchedule::ToUnitInterval(FaultInjector::generator()));
+		}
+	}
+#endif
+
+void FaultInjector::InjectFaultRange(uint8_t* const begin, const size_t elementCount, const size_t stride, const InjectionBer ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
+	#if BULK_RANGE_INJECTION
+		#if LS_BIT_DROPPING
+			const bool isElementWise = (elementCount < FaultInjector::bulkInjectionMinimumElements) || this->HasLSBDropping(); //the dropping touches every element anyway
+		#else
+			const bool isElementWise = (elementCount < FaultInjector::bulkInjectionMinimumElements);
+		#endif
+
+		if (!isElementWise) {
+			g_injectionCalls += elementCount;
+			PROFILE_SCOPE(InjectFault)
+
+			std::vector<std::pair<size_t, size_t>>& faults = FaultInjector::faultScratch;
+			faults.clear();
+
+			for (size_t bitCount = 0; bitCount < this->GetBitDepth(); ++bitCount) {
+				const double bitBer = FaultInjector::GetBitBer(ber, bitCount);
+				if (!(bitBer > 0)) {
+					continue;
+				}
+
+				FaultInjector::ForEachFaultyElement(elementCount, bitBer, [&](const size_t elementIndex) {
+					faults.emplace_back(elementIndex, bitCount);
+
+					#if LOG_FAULTS
+						++injectedByBit[bitCount];
+					#endif
+				});
+			}
+
+			FaultInjector::BackupAndFlip(begin, stride, faults, toBackup);
+			return;
+		}
+	#endif
+
+	for (size_t i = 0; i < elementCount; ++i) {
+		this->InjectFault(begin + (i * stride), ber, toBackup AND_LOG_ARGUMENT(injectedByBit));
+	}
+}
+
+#if BULK_RANGE_INJECTION
+	std::vector<std::pair<size_t, size_t>> FaultInjector::faultScratch;
+
+	//the faulty elements of a range, in increasing order, each one faulty with the given probability
+	//the gaps between consecutive faulty elements are geometric, so the cost follows the number of faults instead of the range length
+	template <typename Visitor>
+	void FaultInjector::ForEachFaultyElement(const size_t elementCount, const double probability, Visitor&& visit) {
+		if (probability >= 1) {
+			for (size_t elementIndex = 0; elementIndex < elementCount; ++elementIndex) {
+				visit(elementIndex);
+			}
+			return;
+		}
+
+		std::geometric_distribution<size_t> gapDistribution(probability); //number of fault-free elements before the next faulty one
+
+		size_t elementIndex = gapDistribution(FaultInjector::generator);
+		while (elementIndex < elementCount) {
+			visit(elementIndex);
+
+			const size_t gap = gapDistribution(FaultInjector::generator);
+			if (gap >= elementCount - elementIndex - 1) { //also keeps the index from wrapping around with huge gaps
+				break;
+			}
+
+			elementIndex += gap + 1;
+		}
+	}
+
+	//each faulty element is backed up once, before its first flip
+	void FaultInjector::BackupAndFlip(uint8_t* const begin, const size_t stride, std::vector<std::pair<size_t, size_t>>& faults, ApproximateBuffer* const toBackup) {
+		std::sort(faults.begin(), faults.end());
+
+		size_t lastBackedupElement = std::numeric_limits<size_t>::max();
+
+		for (const auto& [elementIndex, bitIndex] : faults) {
+			uint8_t* const data = begin + (elementIndex * stride);
+
+			if (toBackup && elementIndex != lastBackedupElement) {
+				BackupReadData(toBackup, data);
+				lastBackedupElement = elementIndex;
+			}
+
+			data[bitIndex/BYTE_SIZE] ^= (FaultInjector::bitMask << (bitIndex % BYTE_SIZE));
+			RECORD_FAULT(data, bitIndex)
+		}
+	}
+#endif
+
 #if OVERCHARGE_FLIP_BACK
 	void FaultInjector::InjectFaultOvercharged(uint8_t* const data, double ber AND_LOG_PARAMETER) {
 		++g_injectionCalls;
@@ -130,6 +348,7 @@ GranularFaultInjector::GranularFaultInjector(const InjectionConfigurationReferen
 
 void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
 	++g_injectionCalls;	
+	PROFILE_SCOPE(InjectFault)
 	const double randomProbability = occurrenceDistribution(FaultInjector::generator);
 
 	if (randomProbability < (ber * static_cast<double>(this->GetBitDepth()))) {
@@ -137,10 +356,11 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 		const uint8_t faultMask = FaultInjector::bitMask << (instanceIndex % BYTE_SIZE);
 
 		if (toBackup) {
-			toBackup->BackupReadData(data);
+			BackupReadData(toBackup, data);
 		}
 
 		data[instanceIndex/BYTE_SIZE] ^= faultMask;
+		RECORD_FAULT(data, instanceIndex)
 
 		#if LOG_FAULTS
 			++injectedByBit[instanceIndex];
@@ -148,6 +368,78 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 	}
 }
 
+#if BER_SCHEDULE
+	void GranularFaultInjector::InjectFault(uint8_t* const data, BerSchedule const * const schedule, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
+		++g_injectionCalls;	
+		PROFILE_SCOPE(InjectFault)
+
+		if (FaultInjector::generator() < schedule->m_faultThreshold) {
+			const size_t instanceIndex = this->m_instanceDistribution(FaultInjector::generator);
+			const uint8_t faultMask = FaultInjector::bitMask << (instanceIndex % BYTE_SIZE);
+
+			if (toBackup) {
+				BackupReadData(toBackup, data);
+			}
+
+			data[instanceIndex/BYTE_SIZE] ^= faultMask;
+			RECORD_FAULT(data, instanceIndex)
+
+			#if LOG_FAULTS
+				++injectedByBit[instanceIndex];
+			#endif
+		}
+	}
+#endif
+
+#if BULK_RANGE_INJECTION
+	double GranularFaultInjector::GetElementBer(const double ber) const {
+		return ber * static_cast<double>(this->GetBitDepth());
+	}
+
+	#if BER_SCHEDULE
+		double GranularFaultInjector::GetElementBer(BerSchedule const * const schedule) const {
+			return schedule->m_faultProbability;
+		}
+	#endif
+#endif
+
+#if BER_SCHEDULE
+	void GranularFaultInjector::InjectFaultRange(uint8_t* const begin, const size_t elementCount, const size_t stride, BerSchedule const * const ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
+#else
+	void GranularFaultInjector::InjectFaultRange(uint8_t* const begin, const size_t elementCount, const size_t stride, const double ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
+#endif
+	#if BULK_RANGE_INJECTION
+		if (elementCount >= FaultInjector::bulkInjectionMinimumElements) {
+			g_injectionCalls += elementCount;
+			PROFILE_SCOPE(InjectFault)
+
+			const double elementProbability = this->GetElementBer(ber);
+			if (!(elementProbability > 0)) {
+				return;
+			}
+
+			std::vector<std::pair<size_t, size_t>>& faults = FaultInjector::faultScratch;
+			faults.clear();
+
+			FaultInjector::ForEachFaultyElement(elementCount, elementProbability, [&](const size_t elementIndex) {
+				const size_t instanceIndex = this->m_instanceDistribution(FaultInjector::generator);
+				faults.emplace_back(elementIndex, instanceIndex);
+
+				#if LOG_FAULTS
+					++injectedByBit[instanceIndex];
+				#endif
+			});
+
+			FaultInjector::BackupAndFlip(begin, stride, faults, toBackup);
+			return;
+		}
+	#endif
+
+	for (size_t i = 0; i < elementCount; ++i) {
+		this->InjectFault(begin + (i * stride), ber, toBackup AND_LOG_ARGUMENT(injectedByBit));
+	}
+}
+
 #if OVERCHARGE_FLIP_BACK
 	void GranularFaultInjector::InjectFaultOvercharged(uint8_t* const data, double ber AND_LOG_PARAMETER) {
 		++g_injectionCalls;
@@ -157,6 +449,7 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 			const uint8_t faultMask = FaultInjector::bitMask << (instanceIndex % BYTE_SIZE);
 
 			data[instanceIndex/BYTE_SIZE] ^= faultMask;
+			RECORD_FAULT(data, instanceIndex)
 
 			#if LOG_FAULTS
 				++injectedByBit[instanceIndex];
@@ -169,9 +462,9 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 
 
 #if DISTANCE_BASED_FAULT_INJECTOR
-	DistanceBasedInjectorRecord::DistanceBasedInjectorRecord(){}
+	DistanceBasedInjectorRecord::DistanceBasedInjectorRecord() IF_BATCHED_DISTANCE_SAMPLING(: m_distanceBatchIndex(DistanceBasedInjectorRecord::distanceBatchSize)) {}
 
-	DistanceBasedInjectorRecord::DistanceBasedInjectorRecord(const std::pair<double, double>& meanAndDev, const size_t dataSizeInBytes, const size_t bitDepth) : m_errorDistanceDistribution(meanAndDev.first, meanAndDev.second) {
+	DistanceBasedInjectorRecord::DistanceBasedInjectorRecord(const std::pair<double, double>& meanAndDev, const size_t dataSizeInBytes, const size_t bitDepth) : m_errorDistanceDistribution(meanAndDev.first, meanAndDev.second) IF_COMMA_BATCHED_DISTANCE_SAMPLING(m_distanceBatchIndex(DistanceBasedInjectorRecord::distanceBatchSize)) {
 		if (!InjectionConfigurationBase::ShouldGoOn(meanAndDev)) {
 			this->m_nextErrorDistance = std::numeric_limits<int64_t>::max();
 		} else {
@@ -181,9 +474,53 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 	}
 
 	int64_t DistanceBasedInjectorRecord::GenerateNewNextErrorDistance() {
-		return static_cast<int64_t>(std::abs(this->m_errorDistanceDistribution(FaultInjector::generator)));
+		#if BATCHED_DISTANCE_SAMPLING
+			if (this->m_distanceBatchIndex == DistanceBasedInjectorRecord::distanceBatchSize) {
+				this->RefillDistanceBatch();
+			}
+
+			return this->m_distanceBatch[this->m_distanceBatchIndex++];
+		#else
+			return static_cast<int64_t>(std::abs(this->m_errorDistanceDistribution(FaultInjector::generator)));
+		#endif
 	}
 
+	#if BATCHED_DISTANCE_SAMPLING
+		//Box-Muller over a whole batch: the uniforms are drawn first, in a fixed order (so a seeded run is reproducible),
+		//and then transformed in a separate loop free of generator calls, which the compiler is able to vectorize
+		void DistanceBasedInjectorRecord::RefillDistanceBatch() {
+			constexpr size_t batchSize = DistanceBasedInjectorRecord::distanceBatchSize;
+
+			if (!this->m_distanceBatch) {
+				this->m_distanceBatch = std::unique_ptr<int64_t[]>(new int64_t[batchSize]);
+			}
+
+			std::array<double, batchSize> uniforms;
+			for (size_t i = 0; i < batchSize; ++i) {
+				uniforms[i] = std::generate_canonical<double, std::numeric_limits<double>::digits>(FaultInjector::generator);
+			}
+
+			const double mean = this->m_errorDistanceDistribution.mean();
+			const double stddev = this->m_errorDistanceDistribution.stddev();
+			constexpr double twoPi = 6.283185307179586476925286766559;
+
+			std::array<double, batchSize> samples;
+			for (size_t i = 0; i < batchSize; i += 2) {
+				const double radius = stddev * std::sqrt(-2.0 * std::log(1.0 - uniforms[i])); //1 - u is in (0, 1]
+				const double angle = twoPi * uniforms[i + 1];
+
+				samples[i]		= mean + (radius * std::cos(angle));
+				samples[i + 1]	= mean + (radius * std::sin(angle));
+			}
+
+			for (size_t i = 0; i < batchSize; ++i) {
+				this->m_distanceBatch[i] = static_cast<int64_t>(std::abs(samples[i]));
+			}
+
+			this->m_distanceBatchIndex = 0;
+		}
+	#endif
+
 	bool DistanceBasedInjectorRecord::IsEnabled() const {
 		return this->m_nextErrorDistance != std::numeric_limits<int64_t>::max();
 	}
@@ -198,7 +535,7 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 	DistanceBasedFaultInjector::DistanceBasedFaultInjector(const InjectionConfigurationReference& injectorCfg, const size_t dataSizeInBytes) : FaultInjector(injectorCfg) , m_dataSizeInBytes(dataSizeInBytes) {
 		#if MULTIPLE_BER_CONFIGURATION
 			for (size_t i = 0; i < ErrorCategory::Size; ++i) {
-				this->m_recordArray[i] = std::unique_ptr<DistanceBasedInjectorRecord[]>((DistanceBasedInjectorRecord*) std::malloc(sizeof(DistanceBasedInjectorRecord) * injectorCfg.GetBerCount(i)));
+				this->m_recordArray[i] = std::unique_ptr<DistanceBasedInjectorRecord[]>(new DistanceBasedInjectorRecord[injectorCfg.GetBerCount(i)]);
 
 				for (size_t j = 0; j < injectorCfg.GetBerCount(i); ++j) {
 					this->m_recordArray[i][j] = DistanceBasedInjectorRecord(injectorCfg.GetBer(i, j), this->m_dataSizeInBytes, this->GetBitDepth());
@@ -258,6 +595,7 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 
 	void DistanceBasedFaultInjector::InjectFault(uint8_t* data, DistanceBasedInjectorRecord& injectorRecord, ssize_t accessSizeInBytes, ApproximateBuffer* const toBackup AND_LOG_PARAMETER) {
 		++g_injectionCalls;
+		PROFILE_SCOPE(InjectFault)
 		const uint8_t* lastBackedupReadData = nullptr; 
 
 		int64_t& errorDistance = injectorRecord.m_nextErrorDistance;
@@ -268,13 +606,14 @@ void GranularFaultInjector::InjectFault(uint8_t* const data, const double ber, A
 			data += (accessSizeInBytes + errorDistance);
 
 			if (toBackup && data != lastBackedupReadData) {
-				toBackup->BackupReadData(data);
+				BackupReadData(toBackup, data);
 				lastBackedupReadData = data;
 			}
 
 			const size_t injectionBit = injectorRecord.m_injectionBit;
 
 			data[injectionBit/BYTE_SIZE] ^= (FaultInjector::bitMask << (injectionBit % BYTE_SIZE));
+			RECORD_FAULT(data, injectionBit)
 
 			#if LOG_FAULTS
 				++injectedByBit[injectionBit];
@@ -7,9 +7,18 @@ class ApproximateBuffer;
 #include <cstring>
 #include <algorithm>
 #include <iostream>
+#include <vector>
+#include <type_traits>
 
 #include "compiling-options.h"
 #include "injector-configuration.h"
+#include "self-profiler.h"
+#include "fault-trace.h"
+#include "instruction-attribution.h"
+#include "access-heatmap.h"
+
+//at every flipped bit
+#define RECORD_FAULT(data, bit) TRACE_FAULT(data, bit) ATTRIBUTE_FAULT() HEATMAP_FAULT(data)
 
 #if LOG_FAULTS
 	#define AND_LOG_PARAMETER , uint64_t* const injectedByBit
@@ -21,13 +30,46 @@ class ApproximateBuffer;
 
 extern uint64_t g_injectionCalls;
 
+#if BER_SCHEDULE
+	typedef std::mt19937_64 RandomEngine; //full 64-bit raw draws, compared against the schedule thresholds
+#else
+	typedef std::default_random_engine RandomEngine;
+#endif
+
 class FaultInjector : public InjectionConfigurationLocal {
 	protected: 
 		static std::uniform_real_distribution<double> occurrenceDistribution;
 		static constexpr uint8_t bitMask = 0b01;
 		static constexpr uint8_t bitDroppingMask = std::numeric_limits<uint8_t>::max();
+
+		#if BIT_DEPTH_KERNELS
+			#if !MULTIPLE_BER_ELEMENT
+				typedef void (*InjectionKernel)(uint8_t* const data, const double ber, const size_t countStart, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+			#else
+				typedef void (*InjectionKernel)(uint8_t* const data, double const * const ber, const size_t countStart, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+			#endif
+
+			//nullptr for depths without a kernel, which are left to the generic loop
+			InjectionKernel m_injectionKernel;
+
+			static InjectionKernel SelectInjectionKernel(const size_t bitDepth);
+
+			template <size_t BitDepth, typename BerType>
+			static void InjectFaultKernel(uint8_t* const data, const BerType ber, const size_t countStart, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+		#endif
+
+		#if BULK_RANGE_INJECTION
+			static constexpr size_t bulkInjectionMinimumElements = 16; //below it, drawing every bit of every element is cheaper than drawing the fault counts
+
+			//scratch of the bulk injection, reused across calls. shared like the generator, as injection is always done under g_pinLock (or by a single thread)
+			static std::vector<std::pair<size_t, size_t>> faultScratch; //<element index, bit index>
+
+			template <typename Visitor>
+			static void ForEachFaultyElement(const size_t elementCount, const double probability, Visitor&& visit);
+			static void BackupAndFlip(uint8_t* const begin, const size_t stride, std::vector<std::pair<size_t, size_t>>& faults, ApproximateBuffer* const toBackup);
+		#endif
 	public:
-		static std::default_random_engine generator;
+		static RandomEngine generator;
 
 		FaultInjector(const InjectionConfigurationReference& injectorCfg);
 
@@ -37,6 +79,13 @@ class FaultInjector : public InjectionConfigurationLocal {
 			void InjectFault(uint8_t* const data, double const * const ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
 		#endif
 
+		#if BER_SCHEDULE
+			void InjectFault(uint8_t* const data, BerSchedule const * const schedule, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+		#endif
+
+		//elementCount elements, stride bytes apart
+		void InjectFaultRange(uint8_t* const begin, const size_t elementCount, const size_t stride, const InjectionBer ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+
 		#if OVERCHARGE_FLIP_BACK
 			void InjectFaultOvercharged(uint8_t* const data, double ber AND_LOG_PARAMETER);
 		#endif
@@ -45,11 +94,27 @@ class FaultInjector : public InjectionConfigurationLocal {
 class GranularFaultInjector : public FaultInjector {
 	protected:
 		std::uniform_int_distribution<size_t> m_instanceDistribution;
+
+		#if BULK_RANGE_INJECTION
+			double GetElementBer(const double ber) const;
+			#if BER_SCHEDULE
+				double GetElementBer(BerSchedule const * const schedule) const;
+			#endif
+		#endif
 	
 	public:
 		GranularFaultInjector(const InjectionConfigurationReference& injectorCfg);
 
 		void InjectFault(uint8_t* const data, const double ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+		#if BER_SCHEDULE
+			void InjectFault(uint8_t* const data, BerSchedule const * const schedule, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+		#endif
+
+		#if BER_SCHEDULE
+			void InjectFaultRange(uint8_t* const begin, const size_t elementCount, const size_t stride, BerSchedule const * const ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+		#else
+			void InjectFaultRange(uint8_t* const begin, const size_t elementCount, const size_t stride, const double ber, ApproximateBuffer* const toBackup AND_LOG_PARAMETER);
+		#endif
 
 		#if OVERCHARGE_FLIP_BACK
 			void InjectFaultOvercharged(uint8_t* const data, double ber AND_LOG_PARAMETER);
@@ -63,6 +128,15 @@ class GranularFaultInjector : public FaultInjector {
 			int64_t m_nextErrorDistance; //in bytes
 			size_t m_injectionBit;
 
+			#if BATCHED_DISTANCE_SAMPLING
+				static constexpr size_t distanceBatchSize = 256; //even, samples come in pairs
+
+				std::unique_ptr<int64_t[]> m_distanceBatch; //allocated on the first refill, so disabled records never pay for it
+				size_t m_distanceBatchIndex;
+
+				void RefillDistanceBatch();
+			#endif
+
 			DistanceBasedInjectorRecord(); //TODO: fix this gambiarra
 			DistanceBasedInjectorRecord(const std::pair<double, double>& meanAndDev, const size_t dataSizeInBytes, const size_t bitDepth);
 
@@ -0,0 +1,41 @@
+#ifndef FAULT_TRACE_LAYOUT_H
+#define FAULT_TRACE_LAYOUT_H
+
+//layout of the fault event trace file, shared between the pintool and the reader (fault_trace_reader/)
+//the file is a Header followed by a plain array of Events, so it can be mmap'ed as is
+//it must not depend on Pin nor on the compiling options
+
+#include <cstdint>
+#include <cstddef>
+
+namespace FaultTraceLayout {
+	constexpr uint64_t MAGIC	= 0x3154464C58525041; //"APRXLFT1"
+	constexpr uint32_t VERSION	= 1;
+
+	struct Header {
+		uint64_t m_magic;
+		uint32_t m_version;
+		uint32_t m_eventSize;		//sizeof(Event)
+		uint64_t m_eventCount;		//only filled at the end of the execution (0 if it did not finish, use the file size instead)
+		uint64_t m_droppedEvents;	//events past the size cap
+		uint64_t m_eventCap;
+		uint32_t m_processId;
+		uint32_t m_reserved0;
+		uint64_t m_reserved[2];
+	};
+
+	struct Event {
+		uint64_t m_period;
+		int64_t m_bufferId;
+		uint64_t m_elementIndex;
+		uint16_t m_bit;
+		uint8_t m_category;			//same order as ErrorCategory: Read, Write, Passive
+		uint8_t m_reserved;
+		uint32_t m_threadId;
+	};
+
+	static_assert(sizeof(Header) == 64, "fault trace header must keep its size");
+	static_assert(sizeof(Event) == 32, "fault trace event must keep its size");
+}
+
+#endif /* FAULT_TRACE_LAYOUT_H */
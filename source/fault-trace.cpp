@@ -0,0 +1,114 @@
+#include "fault-trace.h"
+
+#if FAULT_EVENT_TRACE
+	#include <iostream>
+	#include <atomic>
+	#include <algorithm>
+	#include <fcntl.h>
+	#include <unistd.h>
+
+	namespace FaultTrace {
+		PerThreadSlots<ThreadTrace> g_threadTraces{};
+
+		static int s_fileDescriptor = -1;
+		static uint64_t s_eventCap = 0;
+		static std::atomic<uint64_t> s_reservedEvents{0};
+
+		static bool WriteAt(void const * const data, const size_t size, off_t offset) {
+			uint8_t const * current = static_cast<uint8_t const *>(data);
+			size_t remaining = size;
+
+			while (remaining != 0) {
+				const ssize_t written = pwrite(s_fileDescriptor, current, remaining, offset);
+				if (written <= 0) {
+					return false;
+				}
+
+				current += written;
+				remaining -= static_cast<size_t>(written);
+				offset += written;
+			}
+
+			return true;
+		}
+
+		static FaultTraceLayout::Header BuildHeader(const uint64_t eventCount, const uint64_t droppedEvents) {
+			FaultTraceLayout::Header header{};
+			header.m_magic = FaultTraceLayout::MAGIC;
+			header.m_version = FaultTraceLayout::VERSION;
+			header.m_eventSize = sizeof(FaultTraceLayout::Event);
+			header.m_eventCount = eventCount;
+			header.m_droppedEvents = droppedEvents;
+			header.m_eventCap = s_eventCap;
+			header.m_processId = static_cast<uint32_t>(getpid());
+			return header;
+		}
+
+		void Initialize(const std::string& filename, const uint64_t capInMegabytes) {
+			s_fileDescriptor = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+			if (s_fileDescriptor < 0) {
+				std::cerr << "ApproxSS Error: Unable to create fault trace file: \"" << filename << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			s_eventCap = (capInMegabytes << 20) / sizeof(FaultTraceLayout::Event);
+
+			const FaultTraceLayout::Header header = FaultTrace::BuildHeader(0, 0);
+			if (!FaultTrace::WriteAt(&header, sizeof(header), 0)) {
+				std::cerr << "ApproxSS Error: Unable to write to fault trace file: \"" << filename << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+		}
+
+		//each flush reserves its slots in the file, so threads never write over each other
+		void Flush(ThreadTrace& trace) {
+			if (!trace.m_events) {
+				trace.m_events = std::unique_ptr<FaultTraceLayout::Event[]>(new FaultTraceLayout::Event[EVENTS_PER_FLUSH]);
+				trace.m_eventCount = 0;
+				return;
+			}
+
+			if (trace.m_eventCount == 0) {
+				return;
+			}
+
+			const uint64_t firstEvent = s_reservedEvents.fetch_add(trace.m_eventCount, std::memory_order_relaxed);
+			const uint64_t keptEvents = (firstEvent >= s_eventCap) ? 0 : std::min<uint64_t>(trace.m_eventCount, s_eventCap - firstEvent);
+
+			if (keptEvents != 0) {
+				const off_t offset = static_cast<off_t>(sizeof(FaultTraceLayout::Header) + (firstEvent * sizeof(FaultTraceLayout::Event)));
+				if (!FaultTrace::WriteAt(trace.m_events.get(), keptEvents * sizeof(FaultTraceLayout::Event), offset)) {
+					std::cout << "ApproxSS Warning: Unable to write to the fault trace file, " << keptEvents << " events lost." << std::endl;
+				}
+			}
+
+			trace.m_droppedEvents += trace.m_eventCount - keptEvents;
+			trace.m_eventCount = 0;
+		}
+
+		//NOTE: should only be called after the target application threads are done
+		void Finish() {
+			if (s_fileDescriptor < 0) {
+				return;
+			}
+
+			uint64_t droppedEvents = 0;
+			for (ThreadTrace& trace : g_threadTraces) {
+				FaultTrace::Flush(trace);
+				droppedEvents += trace.m_droppedEvents;
+			}
+
+			const uint64_t eventCount = std::min(s_reservedEvents.load(), s_eventCap);
+			const FaultTraceLayout::Header header = FaultTrace::BuildHeader(eventCount, droppedEvents);
+			FaultTrace::WriteAt(&header, sizeof(header), 0);
+
+			close(s_fileDescriptor);
+			s_fileDescriptor = -1;
+
+			if (droppedEvents != 0) {
+				std::cout << "ApproxSS Warning: The fault trace reached its size cap, " << droppedEvents << " fault events were dropped." << std::endl;
+			}
+		}
+	}
+#endif
@@ -0,0 +1,80 @@
+#ifndef FAULT_TRACE_H
+#define FAULT_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <memory>
+#include <string>
+#include "pin.H"
+
+#include "compiling-options.h"
+#include "per-thread-slots.h"
+
+#if FAULT_EVENT_TRACE
+	#include "fault-trace-layout.h"
+
+	//every injected fault, as a FaultTraceLayout::Event, appended to a binary trace file
+	//events are kept in per-thread blocks and flushed with a single positioned write each, at offsets reserved with an atomic counter (no locks)
+	namespace FaultTrace {
+		constexpr size_t EVENTS_PER_FLUSH	= 16384;	//512 KiB per flush
+
+		//aligned so that threads never share a cache line
+		class alignas(64) ThreadTrace {
+			public:
+				//set by the approximate buffer right before it calls the fault injector
+				int64_t m_bufferId;
+				uint8_t const * m_bufferBegin;
+				size_t m_dataSizeInBytes;
+				uint64_t m_period;
+				uint8_t m_category;
+
+				std::unique_ptr<FaultTraceLayout::Event[]> m_events; //allocated on the first fault
+				size_t m_eventCount;
+				uint64_t m_droppedEvents;
+		};
+
+		extern PerThreadSlots<ThreadTrace> g_threadTraces;
+
+		inline ThreadTrace& GetThreadTrace() {
+			return g_threadTraces.Get();
+		}
+
+		void Initialize(const std::string& filename, const uint64_t capInMegabytes);
+		void Flush(ThreadTrace& trace);
+		void Finish();
+
+		inline void SetContext(const int64_t bufferId, uint8_t const * const bufferBegin, const size_t dataSizeInBytes, const size_t errorCat, const uint64_t period) {
+			ThreadTrace& trace = FaultTrace::GetThreadTrace();
+			trace.m_bufferId = bufferId;
+			trace.m_bufferBegin = bufferBegin;
+			trace.m_dataSizeInBytes = dataSizeInBytes;
+			trace.m_category = static_cast<uint8_t>(errorCat);
+			trace.m_period = period;
+		}
+
+		//data: the faulty element (or a byte inside it, for the distance-based injector)
+		inline void RecordFault(uint8_t const * const data, const size_t bit) {
+			ThreadTrace& trace = FaultTrace::GetThreadTrace();
+
+			if (!trace.m_events || trace.m_eventCount == EVENTS_PER_FLUSH) {
+				FaultTrace::Flush(trace);
+			}
+
+			FaultTraceLayout::Event& event = trace.m_events[trace.m_eventCount++];
+			event.m_period = trace.m_period;
+			event.m_bufferId = trace.m_bufferId;
+			event.m_elementIndex = static_cast<uint64_t>(data - trace.m_bufferBegin) / trace.m_dataSizeInBytes;
+			event.m_bit = static_cast<uint16_t>(bit);
+			event.m_category = trace.m_category;
+			event.m_reserved = 0;
+			event.m_threadId = static_cast<uint32_t>(PIN_ThreadId());
+		}
+	}
+
+	#define TRACE_FAULT(data, bit) FaultTrace::RecordFault(data, bit);
+#else
+	#define TRACE_FAULT(data, bit)
+#endif
+
+#endif /* FAULT_TRACE_H */
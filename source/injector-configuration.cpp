@@ -9,6 +9,53 @@
 	}
 #endif
 
+#if BER_SCHEDULE
+	BerSchedule::BerSchedule() : m_faultThreshold(0), m_faultProbability(0), m_countStart(0) {}
+
+	void BerSchedule::Compile(const ErrorType ber, const size_t bitDepth, const size_t countStart) {
+		//keeps the survival finite, so bits after an always-faulty one still get their own chance
+		constexpr double maximumSurvivalBer = 1.0 - std::numeric_limits<double>::epsilon();
+
+		this->m_countStart = countStart;
+		this->m_bitBers = std::unique_ptr<double[]>(new double[bitDepth]()); //zero-initialized
+		this->m_logSurvival = std::unique_ptr<double[]>(new double[bitDepth + 1]()); //zero-initialized
+
+		const bool isEnabled = InjectionConfigurationBase::ShouldGoOn(ber);
+
+		for (size_t bit = countStart; bit < bitDepth; ++bit) {
+			const double bitBer = isEnabled ? std::min(std::max(InjectionConfigurationBase::GetBitBer(ber, bit), 0.0), 1.0) : 0.0;
+
+			this->m_bitBers[bit] = bitBer;
+			this->m_logSurvival[bit + 1] = this->m_logSurvival[bit] + std::log1p(-std::min(bitBer, maximumSurvivalBer));
+		}
+
+		#if GRANULAR_FAULT_INJECTOR
+			this->m_faultProbability = isEnabled ? std::min(std::max(ber * static_cast<double>(bitDepth), 0.0), 1.0) : 0.0;
+		#else
+			this->m_faultProbability = -std::expm1(this->m_logSurvival[bitDepth]);
+		#endif
+
+		this->m_faultThreshold = BerSchedule::ToThreshold(this->m_faultProbability);
+	}
+
+	uint64_t BerSchedule::ToThreshold(const double probability) {
+		if (!(probability > 0)) {
+			return 0;
+		}
+
+		if (probability >= 1) {
+			return std::numeric_limits<uint64_t>::max();
+		}
+
+		return static_cast<uint64_t>(std::ldexp(probability, 64));
+	}
+
+	//[0, 1), from the 53 most significant bits
+	double BerSchedule::ToUnitInterval(const uint64_t draw) {
+		return std::ldexp(static_cast<double>(draw >> 11), -53);
+	}
+#endif
+
 ErrorType InjectionConfigurationBase::GetZeroBerValue() {
 	#if DISTANCE_BASED_FAULT_INJECTOR
 		return {0, 0};
@@ -212,6 +259,42 @@ std::string InjectionConfigurationReference::toString(const std::string& lineSta
 	}
 #endif
 
+#if BER_SCHEDULE
+	void InjectionConfigurationReference::CompileBerSchedules() {
+		#if LS_BIT_DROPPING
+			const size_t countStart = std::min(this->GetLSBDropped(), this->GetBitDepth());
+		#else
+			constexpr size_t countStart = 0;
+		#endif
+
+		for (size_t errorCat = 0; errorCat < ErrorCategory::Size; ++errorCat) {
+			#if MULTIPLE_BER_CONFIGURATION
+				this->m_schedules[errorCat] = std::unique_ptr<BerSchedule[]>(new BerSchedule[this->GetBerCount(errorCat)]);
+
+				for (size_t i = 0; i < this->GetBerCount(errorCat); ++i) {
+					this->m_schedules[errorCat][i].Compile(this->GetBer(errorCat, i), this->GetBitDepth(), countStart);
+				}
+			#else
+				this->m_schedules[errorCat].Compile(this->GetBer(errorCat), this->GetBitDepth(), countStart);
+			#endif
+		}
+	}
+
+	#if MULTIPLE_BER_CONFIGURATION
+		BerSchedule const * InjectionConfigurationReference::GetBerSchedule(const size_t errorCat, const size_t index) const {
+			return &(this->m_schedules[errorCat][index % this->GetBerCount(errorCat)]);
+		}
+
+		BerSchedule const * InjectionConfigurationReference::GetBerSchedules(const size_t errorCat) const {
+			return this->m_schedules[errorCat].get();
+		}
+	#else
+		BerSchedule const * InjectionConfigurationReference::GetBerSchedule(const size_t errorCat) const {
+			return &(this->m_schedules[errorCat]);
+		}
+	#endif
+#endif
+
 /////////////////////////////////////////////////////////////////////////
 //					InjectionConfigurationLocal
 /////////////////////////////////////////////////////////////////////////
@@ -235,6 +318,9 @@ std::string InjectionConfigurationReference::toString(const std::string& lineSta
 		
 		for (size_t i = 0; i < ErrorCategory::Size; ++i) {
 			this->m_bers[i] = reference.GetBer(i);
+			#if BER_SCHEDULE
+				this->m_schedules[i] = reference.GetBerSchedule(i);
+			#endif
 			this->ReviseShouldGoOn(i);
 		}
 	}
@@ -251,6 +337,10 @@ void InjectionConfigurationLocal::ReviseShouldGoOn(const size_t errorCat) {
 	#if LS_BIT_DROPPING
 		this->m_shouldGoOn[errorCat] = this->m_shouldGoOn[errorCat] || this->HasLSBDropping();
 	#endif
+
+	#if ANALYTIC_ERROR_EXPECTATION
+		this->m_shouldGoOn[errorCat] = false; //errors are only calculated when logging
+	#endif
 }
 
 bool InjectionConfigurationLocal::GetShouldGoOn(const size_t errorCat) const {
@@ -261,6 +351,16 @@ ErrorType InjectionConfigurationLocal::GetBer(const size_t errorCat) const {
 	return this->m_bers[errorCat];
 }
 
+#if !DISTANCE_BASED_FAULT_INJECTOR
+	InjectionBer InjectionConfigurationLocal::GetInjectionBer(const size_t errorCat) const {
+		#if BER_SCHEDULE
+			return this->m_schedules[errorCat];
+		#else
+			return this->m_bers[errorCat];
+		#endif
+	}
+#endif
+
 #if MULTIPLE_BER_CONFIGURATION
 	ErrorType InjectionConfigurationLocal::GetBer(const size_t errorCat, const size_t index) const {
 		return this->m_reference.GetBer(errorCat, index);
@@ -283,9 +383,18 @@ ErrorType InjectionConfigurationLocal::GetBer(const size_t errorCat) const {
 
 	void InjectionConfigurationLocal::UpdateBer(const size_t errorCat) {
 		this->m_bers[errorCat] = this->m_reference.GetBer(errorCat, this->GetBerIndex());
+		#if BER_SCHEDULE
+			this->m_schedules[errorCat] = this->m_reference.GetBerSchedule(errorCat, this->GetBerIndex());
+		#endif
 		this->ReviseShouldGoOn(errorCat);
 	}
 
+	#if BER_SCHEDULE
+		BerScheduleCursor InjectionConfigurationLocal::GetBerScheduleCursor(const size_t errorCat, const uint64_t period) const {
+			return BerScheduleCursor(this->m_reference.GetBerSchedules(errorCat), this->GetBerCount(errorCat), this->GetBerIndexFromPeriod(period) % this->GetBerCount(errorCat));
+		}
+	#endif
+
 	size_t InjectionConfigurationLocal::GetBerCount(const size_t errorCat) const {
 		return this->m_reference.GetBerCount(errorCat);
 	}
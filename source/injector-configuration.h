@@ -9,6 +9,7 @@
 #include <map>
 #include <sstream>
 #include <array>
+#include <cmath>
 
 #include "compiling-options.h"
 
@@ -27,6 +28,33 @@ extern uint64_t g_currentPeriod;
 	#endif
 #endif
 
+#if BER_SCHEDULE
+	//a BER compiled once, at load time, and shared read-only by every buffer of its configuration
+	//the common case (no faulty bit in the element) costs a single raw 64-bit draw compared against an integer threshold
+	//faulty bits are then found with geometric skips over the cumulative per-bit survival, instead of one draw per bit
+	class BerSchedule {
+		public:
+			uint64_t m_faultThreshold;					//P(at least one faulty bit in the element) * 2^64
+			double m_faultProbability;					//P(at least one faulty bit in the element)
+			size_t m_countStart;						//bits below it are left to the LSB dropping
+			std::unique_ptr<double[]> m_bitBers;		//[bitDepth], clamped to [0, 1]
+			std::unique_ptr<double[]> m_logSurvival;	//[bitDepth + 1], log P(no faulty bit in [countStart, bit))
+
+			BerSchedule();
+
+			void Compile(const ErrorType ber, const size_t bitDepth, const size_t countStart);
+
+			static uint64_t ToThreshold(const double probability);
+			static double ToUnitInterval(const uint64_t draw);
+	};
+
+	typedef BerSchedule const *	InjectionBer;	//what the injection paths carry around
+#elif MULTIPLE_BER_ELEMENT
+	typedef double const *		InjectionBer;
+#else
+	typedef double				InjectionBer;
+#endif
+
 //#if MULTIPLE_BER_CONFIGURATION
 	class MultiBer {
 		public:
@@ -72,6 +100,12 @@ class InjectionConfigurationBase {
 		static bool ShouldGoOn(const std::pair<double, double>& ber);
 		static bool ShouldGoOn(const double ber);
 		static bool ShouldGoOn(double const * const ber);
+
+		static double GetBitBer(const double ber, const size_t /*bitIndex*/) { return ber; }
+		static double GetBitBer(double const * const ber, const size_t bitIndex) { return ber[bitIndex]; }
+		#if BER_SCHEDULE
+			static double GetBitBer(BerSchedule const * const schedule, const size_t bitIndex) { return schedule->m_bitBers[bitIndex]; }
+		#endif
 };
 
 class InjectionConfigurationReference : public virtual InjectionConfigurationBase {
@@ -82,6 +116,14 @@ class InjectionConfigurationReference : public virtual InjectionConfigurationBas
 			std::array<ErrorTypeStore, ErrorCategory::Size> m_bers;
 		#endif
 
+		#if BER_SCHEDULE
+			#if MULTIPLE_BER_CONFIGURATION
+				std::array<std::unique_ptr<BerSchedule[]>, ErrorCategory::Size> m_schedules;
+			#else
+				std::array<BerSchedule, ErrorCategory::Size> m_schedules;
+			#endif
+		#endif
+
 	public: 
 		InjectionConfigurationReference();
 
@@ -102,14 +144,45 @@ class InjectionConfigurationReference : public virtual InjectionConfigurationBas
 			ErrorType GetBer(const size_t errorCat) const;
 			void SetBer(const size_t errorCat, ErrorTypeStore& ber);
 		#endif
+
+		#if BER_SCHEDULE
+			void CompileBerSchedules(); //NOTE: once the configuration is completely read
+
+			#if MULTIPLE_BER_CONFIGURATION
+				BerSchedule const * GetBerSchedule(const size_t errorCat, const size_t index) const;
+				BerSchedule const * GetBerSchedules(const size_t errorCat) const;
+			#else
+				BerSchedule const * GetBerSchedule(const size_t errorCat) const;
+			#endif
+		#endif
 };
 
+#if BER_SCHEDULE && MULTIPLE_BER_CONFIGURATION
+	//walks a schedule period by period, wrapping around without recomputing the index of each period
+	class BerScheduleCursor {
+		private:
+			BerSchedule const * const m_schedules;
+			const size_t m_count;
+			size_t m_index;
+
+		public:
+			BerScheduleCursor(BerSchedule const * const schedules, const size_t count, const size_t index) : m_schedules(schedules), m_count(count), m_index(index) {}
+
+			InjectionBer Get() const { return &(this->m_schedules[this->m_index]); }
+			void Advance() { this->m_index = (this->m_index + 1 == this->m_count) ? 0 : (this->m_index + 1); }
+	};
+#endif
+
 class InjectionConfigurationLocal : public virtual InjectionConfigurationBase {
 	private:
 		std::array<bool, ErrorCategory::Size> m_shouldGoOn;
 
 		std::array<ErrorType, ErrorCategory::Size> m_bers;
 
+		#if BER_SCHEDULE
+			std::array<BerSchedule const *, ErrorCategory::Size> m_schedules;
+		#endif
+
 		#if MULTIPLE_BER_CONFIGURATION
 			const InjectionConfigurationReference& m_reference;
 			uint64_t m_creationPeriod;
@@ -123,9 +196,17 @@ class InjectionConfigurationLocal : public virtual InjectionConfigurationBase {
 	
 		ErrorType GetBer(const size_t errorCat) const;
 
+		#if !DISTANCE_BASED_FAULT_INJECTOR
+			InjectionBer GetInjectionBer(const size_t errorCat) const;
+		#endif
+
 		#if MULTIPLE_BER_CONFIGURATION
 			ErrorType GetBer(const size_t errorCat, const size_t index) const;	
 
+			#if BER_SCHEDULE
+				BerScheduleCursor GetBerScheduleCursor(const size_t errorCat, const uint64_t period) const;
+			#endif
+
 			uint64_t GetBerCurrentIndex(const size_t errorCat) const;
 			uint64_t GetCreationPeriod() const;
 			uint64_t GetBerIndex() const;
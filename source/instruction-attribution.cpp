@@ -0,0 +1,120 @@
+#include "instruction-attribution.h"
+
+#if INSTRUCTION_ATTRIBUTION
+	#include <vector>
+	#include <string>
+	#include <unordered_map>
+	#include <algorithm>
+
+	namespace InstructionAttribution {
+		PerThreadSlots<ThreadTable> g_threadTables{};
+
+		void InstructionCounters::Add(const InstructionCounters& other) {
+			for (size_t i = 0; i < AccessPrecision::Size; ++i) {
+				for (size_t j = 0; j < AccessTypes::Size; ++j) {
+					this->m_accessedBytes[i][j] += other.m_accessedBytes[i][j];
+				}
+			}
+
+			this->m_injectedFaults += other.m_injectedFaults;
+		}
+
+		//also allocates the first table, m_current is always set again right after (by BeginAccess)
+		void ThreadTable::Grow() {
+			const size_t oldCapacity = this->m_capacity;
+			std::unique_ptr<InstructionCounters[]> oldEntries = std::move(this->m_entries);
+
+			this->m_capacity = (oldCapacity == 0) ? INITIAL_CAPACITY : (oldCapacity * 2);
+			this->m_entries = std::unique_ptr<InstructionCounters[]>(new InstructionCounters[this->m_capacity]());
+			this->m_usedEntries = 0;
+
+			const size_t mask = this->m_capacity - 1;
+			for (size_t j = 0; j < oldCapacity; ++j) {
+				const InstructionCounters& entry = oldEntries[j];
+				if (entry.m_instructionAddress == NO_INSTRUCTION) {
+					continue;
+				}
+
+				size_t i = ThreadTable::Hash(entry.m_instructionAddress) & mask;
+				while (this->m_entries[i].m_instructionAddress != NO_INSTRUCTION) {
+					i = (i + 1) & mask;
+				}
+
+				this->m_entries[i] = entry;
+				++this->m_usedEntries;
+			}
+		}
+
+		static uint64_t GetApproximateBytes(const InstructionCounters& counters) {
+			return counters.m_accessedBytes[AccessPrecision::Approximate][AccessTypes::Read] + counters.m_accessedBytes[AccessPrecision::Approximate][AccessTypes::Write];
+		}
+
+		static std::string EscapeCsv(const std::string& field) {
+			std::string escaped = "\"";
+			for (const char c : field) {
+				escaped += (c == '"') ? "\"\"" : std::string(1, c);
+			}
+			return escaped + '"';
+		}
+
+		//NOTE: should only be called after the target application threads are done
+		//sorted by injected faults, then by approximate bytes
+		void WriteReportToFile(std::ofstream& outputLog) {
+			std::unordered_map<ADDRINT, InstructionCounters> merged;
+
+			for (const ThreadTable& table : g_threadTables) {
+				for (size_t i = 0; i < table.m_capacity; ++i) {
+					const InstructionCounters& entry = table.m_entries[i];
+					if (entry.m_instructionAddress == NO_INSTRUCTION) {
+						continue;
+					}
+
+					const auto [it, isNew] = merged.emplace(entry.m_instructionAddress, entry);
+					if (!isNew) {
+						it->second.Add(entry);
+					}
+				}
+			}
+
+			std::vector<InstructionCounters const *> sorted;
+			sorted.reserve(merged.size());
+			for (const auto& [_, counters] : merged) {
+				sorted.push_back(&counters);
+			}
+
+			std::sort(sorted.begin(), sorted.end(), [](InstructionCounters const * const lhv, InstructionCounters const * const rhv) {
+				if (lhv->m_injectedFaults != rhv->m_injectedFaults) {
+					return lhv->m_injectedFaults > rhv->m_injectedFaults;
+				}
+				return InstructionAttribution::GetApproximateBytes(*lhv) > InstructionAttribution::GetApproximateBytes(*rhv);
+			});
+
+			outputLog << "address,routine,image,file,line,approximate read bytes,approximate written bytes,precise read bytes,precise written bytes,injected faults" << std::endl;
+
+			PIN_LockClient();
+			for (InstructionCounters const * const counters : sorted) {
+				const ADDRINT address = counters->m_instructionAddress;
+
+				const IMG img = IMG_FindByAddress(address);
+				const std::string imageName = IMG_Valid(img) ? IMG_Name(img) : "";
+
+				INT32 column = 0;
+				INT32 line = 0;
+				std::string fileName;
+				PIN_GetSourceLocation(address, &column, &line, &fileName);
+
+				outputLog << "0x" << std::hex << address << std::dec << ','
+						  << InstructionAttribution::EscapeCsv(PIN_UndecorateSymbolName(RTN_FindNameByAddress(address), UNDECORATION_NAME_ONLY)) << ','
+						  << InstructionAttribution::EscapeCsv(imageName) << ','
+						  << InstructionAttribution::EscapeCsv(fileName) << ','
+						  << line << ','
+						  << counters->m_accessedBytes[AccessPrecision::Approximate][AccessTypes::Read] << ','
+						  << counters->m_accessedBytes[AccessPrecision::Approximate][AccessTypes::Write] << ','
+						  << counters->m_accessedBytes[AccessPrecision::Precise][AccessTypes::Read] << ','
+						  << counters->m_accessedBytes[AccessPrecision::Precise][AccessTypes::Write] << ','
+						  << counters->m_injectedFaults << std::endl;
+			}
+			PIN_UnlockClient();
+		}
+	}
+#endif
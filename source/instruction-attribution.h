@@ -0,0 +1,109 @@
+#ifndef INSTRUCTION_ATTRIBUTION_H
+#define INSTRUCTION_ATTRIBUTION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <memory>
+#include <fstream>
+#include "pin.H"
+
+#include "compiling-options.h"
+#include "per-thread-slots.h"
+
+#if INSTRUCTION_ATTRIBUTION
+	//approximate buffer accesses and injected faults, by the address of the instruction that made (or, for bulk operations, called) the access
+	//each thread keeps its own table, only merged and symbolized at the end of the execution
+	namespace InstructionAttribution {
+		constexpr size_t INITIAL_CAPACITY		= 1024;	//must be a power of two
+		constexpr ADDRINT NO_INSTRUCTION		= 0;
+
+		class InstructionCounters {
+			public:
+				ADDRINT m_instructionAddress;
+				std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> m_accessedBytes;
+				uint64_t m_injectedFaults;
+
+				void Add(const InstructionCounters& other);
+		};
+
+		//open addressing with linear probing, kept at most half full
+		//aligned so that threads never share a cache line
+		class alignas(64) ThreadTable {
+			public:
+				std::unique_ptr<InstructionCounters[]> m_entries;
+				size_t m_capacity;
+				size_t m_usedEntries;
+				InstructionCounters* m_current; //counters of the access being handled, nullptr outside of one (e.g. retirement, next_period)
+
+				void Grow();
+
+				static size_t Hash(const ADDRINT instructionAddress) {
+					return static_cast<size_t>((static_cast<uint64_t>(instructionAddress) * 0x9E3779B97F4A7C15ULL) >> 32);
+				}
+
+				InstructionCounters& Find(const ADDRINT instructionAddress) {
+					if ((this->m_usedEntries + 1) * 2 > this->m_capacity) {
+						this->Grow();
+					}
+
+					const size_t mask = this->m_capacity - 1;
+					for (size_t i = ThreadTable::Hash(instructionAddress) & mask; /**/; i = (i + 1) & mask) {
+						InstructionCounters& entry = this->m_entries[i];
+
+						if (entry.m_instructionAddress == instructionAddress) {
+							return entry;
+						}
+
+						if (entry.m_instructionAddress == NO_INSTRUCTION) {
+							entry.m_instructionAddress = instructionAddress;
+							++this->m_usedEntries;
+							return entry;
+						}
+					}
+				}
+		};
+
+		extern PerThreadSlots<ThreadTable> g_threadTables;
+
+		inline ThreadTable& GetThreadTable() {
+			return g_threadTables.Get();
+		}
+
+		//only called once the access is known to hit an approximate buffer
+		inline void BeginAccess(const ADDRINT instructionAddress) {
+			ThreadTable& table = InstructionAttribution::GetThreadTable();
+			table.m_current = &table.Find(instructionAddress);
+		}
+
+		inline void EndAccess() {
+			InstructionAttribution::GetThreadTable().m_current = nullptr;
+		}
+
+		inline void RecordAccess(const bool isThreadInjectionEnabled, const size_t type, const size_t size) {
+			InstructionCounters * const current = InstructionAttribution::GetThreadTable().m_current;
+			if (current != nullptr) {
+				current->m_accessedBytes[isThreadInjectionEnabled][type] += size;
+			}
+		}
+
+		inline void RecordFault() {
+			InstructionCounters * const current = InstructionAttribution::GetThreadTable().m_current;
+			if (current != nullptr) {
+				++current->m_injectedFaults;
+			}
+		}
+
+		void WriteReportToFile(std::ofstream& outputLog);
+	}
+
+	#define ATTRIBUTION_BEGIN(instructionAddress) InstructionAttribution::BeginAccess(instructionAddress);
+	#define ATTRIBUTION_END() InstructionAttribution::EndAccess();
+	#define ATTRIBUTE_FAULT() InstructionAttribution::RecordFault();
+#else
+	#define ATTRIBUTION_BEGIN(instructionAddress)
+	#define ATTRIBUTION_END()
+	#define ATTRIBUTE_FAULT()
+#endif
+
+#endif /* INSTRUCTION_ATTRIBUTION_H */
@@ -0,0 +1,187 @@
+#include "instrumentation-filter.h"
+
+namespace InstrumentationFilter {
+	static std::vector<std::string> s_imagePatterns;
+	static std::vector<std::string> s_routinePatterns;
+	static bool s_warnExcludedAccesses = false;
+
+	//instrumentation callbacks are serialized by Pin, so these need no locking
+	static std::unordered_map<ADDRINT, bool> s_routineDecisions;	//by routine address, dropped when its image is unloaded
+	static std::map<std::string, ExcludedRoutine> s_excludedRoutines;	//by image and routine name, nodes are never moved (analysis calls keep pointers to them)
+
+	void AddImagePattern(const std::string& pattern) {
+		if (!pattern.empty()) {
+			s_imagePatterns.push_back(pattern);
+		}
+	}
+
+	void AddRoutinePattern(const std::string& pattern) {
+		if (!pattern.empty()) {
+			s_routinePatterns.push_back(pattern);
+		}
+	}
+
+	void SetWarnExcludedAccesses(const bool warn) {
+		s_warnExcludedAccesses = warn;
+	}
+
+	bool IsActive() {
+		return !s_imagePatterns.empty() || !s_routinePatterns.empty();
+	}
+
+	bool IsWarningEnabled() {
+		return s_warnExcludedAccesses && InstrumentationFilter::IsActive();
+	}
+
+	//'*' matches any sequence (including an empty one), '?' matches any single character
+	bool MatchesGlob(char const * pattern, char const * text) {
+		char const * starPattern = nullptr;
+		char const * starText = nullptr;
+
+		while (*text != '\0') {
+			if (*pattern == '*') {
+				starPattern = ++pattern;
+				starText = text;
+			} else if (*pattern == '?' || *pattern == *text) {
+				++pattern;
+				++text;
+			} else if (starPattern != nullptr) {
+				pattern = starPattern;
+				text = ++starText;
+			} else {
+				return false;
+			}
+		}
+
+		while (*pattern == '*') {
+			++pattern;
+		}
+
+		return *pattern == '\0';
+	}
+
+	static bool MatchesAny(const std::vector<std::string>& patterns, const std::string& name) {
+		for (const std::string& pattern : patterns) {
+			if (InstrumentationFilter::MatchesGlob(pattern.c_str(), name.c_str())) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//full path or file name
+	static bool IsImageIncluded(const IMG img) {
+		if (s_imagePatterns.empty()) {
+			return true;
+		}
+
+		if (!IMG_Valid(img)) {
+			return false;
+		}
+
+		const std::string imageName = IMG_Name(img);
+		const size_t lastSlash = imageName.find_last_of('/');
+
+		return InstrumentationFilter::MatchesAny(s_imagePatterns, imageName) || (lastSlash != std::string::npos && InstrumentationFilter::MatchesAny(s_imagePatterns, imageName.substr(lastSlash + 1)));
+	}
+
+	//mangled or undecorated name
+	static bool IsRoutineIncluded(const RTN rtn) {
+		if (s_routinePatterns.empty()) {
+			return true;
+		}
+
+		if (!RTN_Valid(rtn)) {
+			return false;
+		}
+
+		const std::string routineName = RTN_Name(rtn);
+
+		return InstrumentationFilter::MatchesAny(s_routinePatterns, routineName) || InstrumentationFilter::MatchesAny(s_routinePatterns, PIN_UndecorateSymbolName(routineName, UNDECORATION_NAME_ONLY));
+	}
+
+	bool ShouldInstrument(const INS ins) {
+		if (!InstrumentationFilter::IsActive()) {
+			return true;
+		}
+
+		const RTN rtn = INS_Rtn(ins);
+		if (!RTN_Valid(rtn)) {
+			return s_routinePatterns.empty() && InstrumentationFilter::IsImageIncluded(IMG_FindByAddress(INS_Address(ins)));
+		}
+
+		return InstrumentationFilter::ShouldInstrumentRoutine(rtn);
+	}
+
+	bool ShouldInstrumentRoutine(const RTN rtn) {
+		if (!InstrumentationFilter::IsActive()) {
+			return true;
+		}
+
+		const std::unordered_map<ADDRINT, bool>::const_iterator it = s_routineDecisions.find(RTN_Address(rtn));
+		if (it != s_routineDecisions.cend()) {
+			return it->second;
+		}
+
+		const bool decision = InstrumentationFilter::IsImageIncluded(SEC_Img(RTN_Sec(rtn))) && InstrumentationFilter::IsRoutineIncluded(rtn);
+		s_routineDecisions.emplace(RTN_Address(rtn), decision);
+
+		return decision;
+	}
+
+	void ForgetImage(const IMG img) {
+		const ADDRINT lowAddress = IMG_LowAddress(img);
+		const ADDRINT highAddress = IMG_HighAddress(img); //inclusive
+
+		for (std::unordered_map<ADDRINT, bool>::const_iterator it = s_routineDecisions.cbegin(); it != s_routineDecisions.cend(); ) {
+			if (it->first >= lowAddress && it->first <= highAddress) {
+				it = s_routineDecisions.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	ExcludedRoutine* GetExcludedRoutine(const INS ins) {
+		const RTN rtn = INS_Rtn(ins);
+		const IMG img = RTN_Valid(rtn) ? SEC_Img(RTN_Sec(rtn)) : IMG_FindByAddress(INS_Address(ins));
+
+		const std::string routineName = RTN_Valid(rtn) ? PIN_UndecorateSymbolName(RTN_Name(rtn), UNDECORATION_NAME_ONLY) : "[unknown routine]";
+		const std::string imageName = IMG_Valid(img) ? IMG_Name(img) : "[unknown image]";
+
+		const std::string key = imageName + '\n' + routineName;
+		std::map<std::string, ExcludedRoutine>::iterator it = s_excludedRoutines.find(key);
+		if (it == s_excludedRoutines.end()) {
+			it = s_excludedRoutines.emplace(key, ExcludedRoutine(routineName, imageName)).first;
+		}
+
+		return &(it->second);
+	}
+
+	void PrintConfiguration() {
+		if (!InstrumentationFilter::IsActive()) {
+			return;
+		}
+
+		std::cout << std::string(50, '#') << std::endl;
+		std::cout << "ACCESS INSTRUMENTATION RESTRICTED TO:" << std::endl;
+		for (const std::string& pattern : s_imagePatterns) {
+			std::cout << "\tImage: " << pattern << std::endl;
+		}
+		for (const std::string& pattern : s_routinePatterns) {
+			std::cout << "\tRoutine: " << pattern << std::endl;
+		}
+		std::cout << "\tWarn about excluded accesses: " << (s_warnExcludedAccesses ? "Enabled" : "Disabled") << std::endl;
+		std::cout << std::string(50, '#') << std::endl;
+	}
+
+	//NOTE: should only be called after the target application threads are done
+	void WriteExcludedAccessWarnings() {
+		for (const auto& [_, excluded] : s_excludedRoutines) {
+			if (excluded.m_approximateAccesses != 0) {
+				std::cout << "ApproxSS Warning: " << excluded.m_approximateAccesses << " accesses to approximate buffers from excluded code: \"" << excluded.m_routineName << "\" (" << excluded.m_imageName << ")." << std::endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#ifndef INSTRUMENTATION_FILTER_H
+#define INSTRUMENTATION_FILTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <iostream>
+#include "pin.H"
+
+#include "compiling-options.h"
+
+//allow-lists restricting memory access instrumentation to chosen images and/or routines, decided at instrumentation time
+//an instruction is instrumented only if it matches the image list (when not empty) AND the routine list (when not empty)
+namespace InstrumentationFilter {
+	//code left out by the allow-lists that was seen accessing approximate buffers (warning mode only)
+	class ExcludedRoutine {
+		public:
+			const std::string m_routineName;
+			const std::string m_imageName;
+			uint64_t m_approximateAccesses;
+
+			ExcludedRoutine(const std::string& routineName, const std::string& imageName) : m_routineName(routineName), m_imageName(imageName), m_approximateAccesses(0) {}
+	};
+
+	void AddImagePattern(const std::string& pattern);
+	void AddRoutinePattern(const std::string& pattern);
+	void SetWarnExcludedAccesses(const bool warn);
+
+	bool IsActive();
+	bool IsWarningEnabled();
+
+	bool MatchesGlob(char const * pattern, char const * text);
+
+	bool ShouldInstrument(const INS ins);
+	bool ShouldInstrumentRoutine(const RTN rtn);
+	ExcludedRoutine* GetExcludedRoutine(const INS ins);
+
+	//drops the decisions of the image's routines, as another image may be loaded at the same addresses
+	void ForgetImage(const IMG img);
+
+	void PrintConfiguration();
+	void WriteExcludedAccessWarnings();
+}
+
+#endif /* INSTRUMENTATION_FILTER_H */
@@ -0,0 +1,75 @@
+#ifndef LIVE_STATISTICS_LAYOUT_H
+#define LIVE_STATISTICS_LAYOUT_H
+
+//layout of the live statistics shared-memory region, shared between the pintool and the reader (live_statistics_reader/)
+//it must not depend on Pin nor on the compiling options, so every array has its maximum size
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+
+namespace LiveStatisticsLayout {
+	constexpr uint64_t MAGIC				= 0x3153535852505041; //"APPRXSS1"
+	constexpr uint32_t VERSION				= 1;
+
+	constexpr size_t ACCESS_PRECISIONS		= 2; //Precise, Approximate
+	constexpr size_t ACCESS_TYPES			= 2; //Read, Write
+	constexpr size_t ERROR_CATEGORIES		= 3; //Read, Write, Passive
+	constexpr size_t PROFILED_SECTIONS		= 8; //same order as ProfiledSection
+
+	struct Snapshot {
+		uint64_t m_currentPeriod;
+		uint64_t m_activeBuffers;
+		uint64_t m_injectionCalls;
+		uint64_t m_publications;
+		uint64_t m_elapsedNanoseconds;	//since the pintool started
+		uint64_t m_isFinished;			//set by the last publication, at Fini
+
+		uint64_t m_accessedBytes[ACCESS_PRECISIONS][ACCESS_TYPES];
+		double m_injectedErrors[ERROR_CATEGORIES];	//only counted with LOG_FAULTS, and only as periods close
+
+		uint64_t m_profiledCalls[PROFILED_SECTIONS];	//only filled with SELF_PROFILING
+		uint64_t m_profiledCycles[PROFILED_SECTIONS];
+	};
+
+	struct Region {
+		uint64_t m_magic;
+		uint32_t m_version;
+		uint32_t m_processId;
+		std::atomic<uint64_t> m_sequence; //seqlock: odd while the snapshot is being written
+		Snapshot m_snapshot;
+	};
+
+	//single writer
+	inline void WriteSnapshot(Region& region, const Snapshot& snapshot) {
+		const uint64_t sequence = region.m_sequence.load(std::memory_order_relaxed);
+		region.m_sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		std::memcpy(&region.m_snapshot, &snapshot, sizeof(Snapshot));
+
+		region.m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	//returns false if the writer kept interfering for too long
+	inline bool ReadSnapshot(const Region& region, Snapshot& snapshot, const size_t maxAttempts = 1000) {
+		for (size_t attempt = 0; attempt < maxAttempts; ++attempt) {
+			const uint64_t before = region.m_sequence.load(std::memory_order_acquire);
+			if (before & 1) {
+				continue;
+			}
+
+			std::memcpy(&snapshot, &region.m_snapshot, sizeof(Snapshot));
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (region.m_sequence.load(std::memory_order_relaxed) == before) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+#endif /* LIVE_STATISTICS_LAYOUT_H */
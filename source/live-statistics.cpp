@@ -0,0 +1,163 @@
+#include "live-statistics.h"
+
+#if LIVE_STATISTICS
+	#include <iostream>
+	#include <ctime>
+	#include <new>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include "self-profiler.h"
+
+	extern uint64_t g_currentPeriod;
+	extern uint64_t g_injectionCalls;
+
+	static_assert(AccessPrecision::Size == LiveStatisticsLayout::ACCESS_PRECISIONS, "live statistics layout out of sync with AccessPrecision");
+	static_assert(AccessTypes::Size == LiveStatisticsLayout::ACCESS_TYPES, "live statistics layout out of sync with AccessTypes");
+	static_assert(ErrorCategory::Size <= LiveStatisticsLayout::ERROR_CATEGORIES, "live statistics layout out of sync with ErrorCategory");
+	#if SELF_PROFILING
+		static_assert(ProfiledSection::Size == LiveStatisticsLayout::PROFILED_SECTIONS, "live statistics layout out of sync with ProfiledSection");
+	#endif
+
+	namespace LiveStatistics {
+		std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> g_accessedBytes{};
+		std::array<double, ErrorCategory::Size> g_injectedErrors{};
+		uint64_t g_activeBuffers = 0;
+
+		static LiveStatisticsLayout::Region* s_region = nullptr;
+		static std::string s_path;
+		static UINT32 s_interval = 1000;
+		static uint64_t s_publications = 0;
+		static uint64_t s_startNanoseconds = 0;
+
+		static volatile bool s_stopPublisher = false;
+		static PIN_THREAD_UID s_publisherUid;
+		static bool s_isPublisherRunning = false;
+
+		static uint64_t GetMonotonicNanoseconds() {
+			timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+		}
+
+		//NOTE: reads the totals without synchronization, a publication may be off by the accesses that happen while it is being built
+		static void Publish(const bool isFinished) {
+			LiveStatisticsLayout::Snapshot snapshot{};
+
+			snapshot.m_currentPeriod = g_currentPeriod;
+			snapshot.m_activeBuffers = g_activeBuffers;
+			snapshot.m_injectionCalls = g_injectionCalls;
+			snapshot.m_publications = ++s_publications;
+			snapshot.m_elapsedNanoseconds = GetMonotonicNanoseconds() - s_startNanoseconds;
+			snapshot.m_isFinished = isFinished;
+
+			for (size_t i = 0; i < AccessPrecision::Size; ++i) {
+				for (size_t j = 0; j < AccessTypes::Size; ++j) {
+					snapshot.m_accessedBytes[i][j] = g_accessedBytes[i][j];
+				}
+			}
+
+			for (size_t i = 0; i < ErrorCategory::Size; ++i) {
+				snapshot.m_injectedErrors[i] = g_injectedErrors[i];
+			}
+
+			#if SELF_PROFILING
+				for (const SelfProfiler::ThreadCounters& counters : SelfProfiler::g_threadCounters) {
+					for (size_t i = 0; i < ProfiledSection::Size; ++i) {
+						snapshot.m_profiledCalls[i] += counters.m_calls[i];
+						snapshot.m_profiledCycles[i] += counters.m_cycles[i];
+					}
+				}
+			#endif
+
+			LiveStatisticsLayout::WriteSnapshot(*s_region, snapshot);
+		}
+
+		static VOID Publisher(VOID* v) {
+			while (!s_stopPublisher && !PIN_IsProcessExiting()) {
+				LiveStatistics::Publish(false);
+				PIN_Sleep(s_interval);
+			}
+		}
+
+		void Initialize(std::string name, const UINT32 intervalInMilliseconds) {
+			if (intervalInMilliseconds == 0) {
+				std::cerr << "ApproxSS Error: Live statistics publication interval must be greater than zero." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			if (name.empty()) {
+				name = "approxss_" + std::to_string(getpid());
+			}
+
+			if (name.find('/') != std::string::npos) {
+				std::cerr << "ApproxSS Error: Live statistics segment name must not contain '/': \"" << name << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			//plain open() on /dev/shm rather than shm_open(), which is not always available to pintools
+			s_path = "/dev/shm/" + name;
+			const int fd = open(s_path.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+			if (fd < 0) {
+				std::cerr << "ApproxSS Error: Unable to create live statistics segment: \"" << s_path << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			if (ftruncate(fd, sizeof(LiveStatisticsLayout::Region)) != 0) {
+				close(fd);
+				std::cerr << "ApproxSS Error: Unable to size live statistics segment: \"" << s_path << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			void* const mapping = mmap(nullptr, sizeof(LiveStatisticsLayout::Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			close(fd);
+
+			if (mapping == MAP_FAILED) {
+				std::cerr << "ApproxSS Error: Unable to map live statistics segment: \"" << s_path << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			s_region = new (mapping) LiveStatisticsLayout::Region();
+			s_region->m_version = LiveStatisticsLayout::VERSION;
+			s_region->m_processId = static_cast<uint32_t>(getpid());
+
+			s_interval = intervalInMilliseconds;
+			s_startNanoseconds = GetMonotonicNanoseconds();
+
+			LiveStatistics::Publish(false);
+
+			//the magic goes last, so a reader never accepts a half-initialized region
+			std::atomic_thread_fence(std::memory_order_release);
+			s_region->m_magic = LiveStatisticsLayout::MAGIC;
+
+			std::cout << "ApproxSS: publishing live statistics at \"" << s_path << "\" every " << s_interval << " ms." << std::endl;
+		}
+
+		void StartPublisher() {
+			if (PIN_SpawnInternalThread(LiveStatistics::Publisher, nullptr, 0, &s_publisherUid) == INVALID_THREADID) {
+				std::cout << "ApproxSS Warning: Unable to spawn the live statistics publisher thread, only the final statistics will be published." << std::endl;
+				return;
+			}
+
+			s_isPublisherRunning = true;
+		}
+
+		//must be registered with PIN_AddPrepareForFiniFunction: internal threads have to be gone before Fini
+		VOID StopPublisher(VOID* v) {
+			s_stopPublisher = true;
+
+			if (s_isPublisherRunning) {
+				PIN_WaitForThreadTermination(s_publisherUid, PIN_INFINITE_TIMEOUT, nullptr);
+				s_isPublisherRunning = false;
+			}
+		}
+
+		//NOTE: the segment is left in /dev/shm so that readers can still see the final statistics, it is truncated on the next run with the same name
+		void Finish() {
+			LiveStatistics::Publish(true);
+
+			munmap(s_region, sizeof(LiveStatisticsLayout::Region));
+			s_region = nullptr;
+		}
+	}
+#endif
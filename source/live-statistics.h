@@ -0,0 +1,28 @@
+#ifndef LIVE_STATISTICS_H
+#define LIVE_STATISTICS_H
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include "pin.H"
+
+#include "compiling-options.h"
+
+#if LIVE_STATISTICS
+	#include "live-statistics-layout.h"
+
+	//running totals published to a shared-memory region (/dev/shm/<name>) by an internal pintool thread
+	//the totals themselves are only written by the target application threads (under g_pinLock when PIN_LOCKED), the publisher only reads them
+	namespace LiveStatistics {
+		extern std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> g_accessedBytes;
+		extern std::array<double, ErrorCategory::Size> g_injectedErrors;
+		extern uint64_t g_activeBuffers;
+
+		void Initialize(std::string name, const UINT32 intervalInMilliseconds);
+		void StartPublisher();
+		VOID StopPublisher(VOID* v);
+		void Finish();
+	}
+#endif
+
+#endif /* LIVE_STATISTICS_H */
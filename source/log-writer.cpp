@@ -0,0 +1,84 @@
+#include "log-writer.h"
+
+#if PARALLEL_LOG_WRITING
+	#include <iostream>
+	#include <atomic>
+
+	namespace LogWriter {
+		class Round {
+			public:
+				const std::function<void(const size_t)>& m_task;
+				const size_t m_taskCount;
+				std::atomic<size_t> m_nextTask;
+
+				Round(const std::function<void(const size_t)>& task, const size_t taskCount) : m_task(task), m_taskCount(taskCount), m_nextTask(0) {}
+
+				void Work() {
+					for (size_t i = this->m_nextTask.fetch_add(1, std::memory_order_relaxed); i < this->m_taskCount; i = this->m_nextTask.fetch_add(1, std::memory_order_relaxed)) {
+						this->m_task(i);
+					}
+				}
+		};
+
+		static std::vector<PIN_THREAD_UID> s_workerUids;
+		static PIN_SEMAPHORE s_roundReady;
+		static Round* s_round = nullptr; //set before s_roundReady
+
+		static VOID Worker(VOID* v) {
+			PIN_SemaphoreWait(&s_roundReady);
+			s_round->Work();
+		}
+
+		void StartWorkers(const UINT32 threadCount) {
+			if (threadCount == 0) {
+				std::cerr << "ApproxSS Error: the number of log writer threads must be greater than 0." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			if (!PIN_SemaphoreInit(&s_roundReady)) {
+				std::cout << "ApproxSS Warning: Unable to create the log writer semaphore, the logs will be formatted by the exiting thread alone." << std::endl;
+				return;
+			}
+
+			for (UINT32 i = 1; i < threadCount; ++i) {
+				PIN_THREAD_UID uid;
+				if (PIN_SpawnInternalThread(LogWriter::Worker, nullptr, 0, &uid) == INVALID_THREADID) {
+					std::cout << "ApproxSS Warning: Unable to spawn every log writer thread, the logs will be formatted by " << i << " thread(s)." << std::endl;
+					break;
+				}
+				s_workerUids.push_back(uid);
+			}
+		}
+
+		static void JoinWorkers() {
+			for (const PIN_THREAD_UID& uid : s_workerUids) {
+				PIN_WaitForThreadTermination(uid, PIN_INFINITE_TIMEOUT, nullptr);
+			}
+
+			s_workerUids.clear();
+			s_round = nullptr;
+		}
+
+		//the calling thread works too, so the tasks are still all run (serially) if no writer thread is left
+		void RunTasks(const size_t taskCount, const std::function<void(const size_t)>& task) {
+			Round round(task, taskCount);
+
+			if (!s_workerUids.empty()) {
+				s_round = &round;
+				PIN_SemaphoreSet(&s_roundReady);
+				round.Work();
+				LogWriter::JoinWorkers();
+			} else {
+				round.Work();
+			}
+		}
+
+		void WriteChunks(std::ofstream& outputLog, const std::vector<std::ostringstream>& chunks, const std::function<void(const size_t)>& afterChunk) {
+			for (size_t i = 0; i < chunks.size(); ++i) {
+				const std::string text = chunks[i].str();
+				outputLog.write(text.data(), static_cast<std::streamsize>(text.size()));
+				afterChunk(i);
+			}
+		}
+	}
+#endif
@@ -0,0 +1,30 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <functional>
+#include "pin.H"
+
+#include "compiling-options.h"
+
+#if PARALLEL_LOG_WRITING
+	//formats the chunks of the logs (e.g. one per buffer) over internal pintool threads, each into its own memory stream, which are then written in order
+	//the output is the same as formatting the chunks one after the other straight into the log
+	//Pin only lets internal threads run until the PrepareForFini callbacks, so the threads are spawned at start up and the chunks formatted in a PrepareForFini callback, leaving only the writing to Fini
+	namespace LogWriter {
+		//spawns threadCount - 1 writer threads (the calling thread of RunTasks is the last one), which wait for the tasks
+		void StartWorkers(const UINT32 threadCount);
+
+		//task(i) for every i < taskCount, over the writer threads and the calling thread. the writer threads exit afterwards (internal threads have to be gone before Fini), so only the first call is parallel
+		void RunTasks(const size_t taskCount, const std::function<void(const size_t)>& task);
+
+		//afterChunk(i) runs right after chunk i is written
+		void WriteChunks(std::ofstream& outputLog, const std::vector<std::ostringstream>& chunks, const std::function<void(const size_t)>& afterChunk);
+	}
+#endif
+
+#endif /* LOG_WRITER_H */
@@ -0,0 +1,51 @@
+#ifndef PER_THREAD_SLOTS_H
+#define PER_THREAD_SLOTS_H
+
+#include <cstddef>
+#include <array>
+#include "pin.H"
+
+#include "compiling-options.h"
+
+//one T per thread, indexed by Pin thread id, so that each thread updates its own without locking (T is expected to be alignas(64), so threads never share a cache line)
+//the same policy for every per-thread table: without PIN_LOCKED the target application is single-threaded and everything goes to the first slot,
+//with it, threads past MAX_THREADS (and Pin internal threads) share the last slot, which is only safe for what they update under g_pinLock
+template <typename T>
+class PerThreadSlots {
+	public:
+		static constexpr size_t MAX_THREADS = 256;
+
+	private:
+		std::array<T, MAX_THREADS> m_slots;
+
+	public:
+		static size_t GetSlotIndex() {
+			#if PIN_LOCKED
+				const size_t threadId = static_cast<size_t>(PIN_ThreadId());
+				return (threadId < MAX_THREADS) ? threadId : (MAX_THREADS - 1);
+			#else
+				return 0;
+			#endif
+		}
+
+		//the calling thread's slot
+		T& Get() {
+			return this->m_slots[PerThreadSlots::GetSlotIndex()];
+		}
+
+		//every slot, for the merging at the end of the execution
+		T& operator[](const size_t slot) {
+			return this->m_slots[slot];
+		}
+
+		const T& operator[](const size_t slot) const {
+			return this->m_slots[slot];
+		}
+
+		typename std::array<T, MAX_THREADS>::iterator begin() { return this->m_slots.begin(); }
+		typename std::array<T, MAX_THREADS>::iterator end() { return this->m_slots.end(); }
+		typename std::array<T, MAX_THREADS>::const_iterator begin() const { return this->m_slots.cbegin(); }
+		typename std::array<T, MAX_THREADS>::const_iterator end() const { return this->m_slots.cend(); }
+};
+
+#endif /* PER_THREAD_SLOTS_H */
@@ -1,16 +1,34 @@
 #include "period-log.h"
+#include "live-statistics.h"
 
 PeriodLog::PeriodLog(PeriodLog &other, const size_t bitDepth) {
 	this->m_period = other.m_period;
 
-	std::copy_n(&(other.m_accessedBytesCount[0][0]), AccessPrecision::Size * AccessTypes::Size, &(this->m_accessedBytesCount[0][0]));
+	#if LAZY_PERIOD_ADVANCEMENT
+		this->m_periodCount = other.m_periodCount;
+	#endif
 
-	#if LOG_FAULTS
-		for (size_t i = 0; i < ErrorCategory::Size; ++i) {
-			this->m_errorsCountsByBit[i] = std::make_unique<uint64_t[]>(bitDepth);
-			std::copy_n(other.m_errorsCountsByBit[i].get(), bitDepth, this->m_errorsCountsByBit[i].get());
-			std::swap(other.m_errorsCountsByBit[i], this->m_errorsCountsByBit[i]);
-		}
+	#if PERSISTENT_COUNTERS
+		//same as the swap below: the stored log keeps the record, the current one goes on with a copy
+		this->m_record = other.m_record;
+		other.m_record = PersistentCounters::AddPeriod(this->m_record->m_bufferRecord, bitDepth);
+		std::copy_n(&(this->m_record->m_accessedBytes[0][0]), AccessPrecision::Size * AccessTypes::Size, &(other.m_record->m_accessedBytes[0][0]));
+
+		#if LOG_FAULTS
+			for (size_t i = 0; i < ErrorCategory::Size; ++i) {
+				std::copy_n(PersistentCountersLayout::GetErrorCountsByBit(this->m_record, i), bitDepth, PersistentCountersLayout::GetErrorCountsByBit(other.m_record, i));
+			}
+		#endif
+	#else
+		std::copy_n(&(other.m_accessedBytesCount[0][0]), AccessPrecision::Size * AccessTypes::Size, &(this->m_accessedBytesCount[0][0]));
+
+		#if LOG_FAULTS
+			for (size_t i = 0; i < ErrorCategory::Size; ++i) {
+				this->m_errorsCountsByBit[i] = std::make_unique<uint64_t[]>(bitDepth);
+				std::copy_n(other.m_errorsCountsByBit[i].get(), bitDepth, this->m_errorsCountsByBit[i].get());
+				std::swap(other.m_errorsCountsByBit[i], this->m_errorsCountsByBit[i]);
+			}
+		#endif
 	#endif
 
 	#if MULTIPLE_BER_CONFIGURATION
@@ -18,10 +36,20 @@ PeriodLog::PeriodLog(PeriodLog &other, const size_t bitDepth) {
 			this->m_berIndex[i] = other.m_berIndex[i];
 		}
 	#endif
+
+	#if PERIOD_SAMPLING
+		this->m_isSampled = other.m_isSampled;
+	#endif
+
+	#if PERSISTENT_COUNTERS
+		other.UpdateRecord();
+	#endif
 }
 
-PeriodLog::PeriodLog(const uint64_t period, const InjectionConfigurationLocal &injectorCfg) {
-	#if LOG_FAULTS
+PeriodLog::PeriodLog(const uint64_t period, const InjectionConfigurationLocal &injectorCfg IF_COMMA_PERSISTENT_COUNTERS(const uint64_t bufferRecord)) {
+	#if PERSISTENT_COUNTERS
+		this->m_record = PersistentCounters::AddPeriod(bufferRecord, injectorCfg.GetBitDepth());
+	#elif LOG_FAULTS
 		for (size_t i = 0; i < ErrorCategory::Size; ++i) {
 			this->m_errorsCountsByBit[i] = std::make_unique<uint64_t[]>(injectorCfg.GetBitDepth());
 		}
@@ -30,13 +58,45 @@ PeriodLog::PeriodLog(const uint64_t period, const InjectionConfigurationLocal &i
 	this->ResetCounts(period, injectorCfg);
 }
 
+#if PERSISTENT_COUNTERS
+	PeriodLog::~PeriodLog() {
+		PersistentCounters::ReleasePeriod(this->m_record);
+	}
+
+	//the fields the reader needs besides the counters, to be called whenever they change
+	void PeriodLog::UpdateRecord() const {
+		this->m_record->m_period = this->m_period;
+
+		#if LAZY_PERIOD_ADVANCEMENT
+			this->m_record->m_periodCount = this->m_periodCount;
+		#else
+			this->m_record->m_periodCount = 1;
+		#endif
+
+		#if MULTIPLE_BER_CONFIGURATION
+			for (size_t i = 0; i < ErrorCategory::Size; ++i) {
+				this->m_record->m_berIndex[i] = this->m_berIndex[i];
+			}
+		#endif
+
+		#if PERIOD_SAMPLING
+			this->m_record->m_isSampled = this->m_isSampled;
+		#endif
+	}
+#endif
+
 void PeriodLog::ResetCounts(const uint64_t period, const InjectionConfigurationLocal &injectorCfg) {
 	this->m_period = period;
-	std::fill_n(&(this->m_accessedBytesCount[0][0]), AccessPrecision::Size * AccessTypes::Size, 0);
+
+	#if LAZY_PERIOD_ADVANCEMENT
+		this->m_periodCount = 1;
+	#endif
+
+	std::fill_n(&(this->AccessedBytesCount(0, 0)), AccessPrecision::Size * AccessTypes::Size, 0);
 
 	#if LOG_FAULTS
 		for (size_t i = 0; i < ErrorCategory::Size; ++i) {
-			std::fill_n(this->m_errorsCountsByBit[i].get(), injectorCfg.GetBitDepth(), 0);
+			std::fill_n(this->GetErrorCountsByBit(i), injectorCfg.GetBitDepth(), 0);
 		}
 	#endif
 
@@ -45,6 +105,14 @@ void PeriodLog::ResetCounts(const uint64_t period, const InjectionConfigurationL
 			this->m_berIndex[i] = injectorCfg.GetBerCurrentIndex(i);
 		}
 	#endif
+
+	#if PERIOD_SAMPLING
+		this->m_isSampled = g_isSampledPeriod;
+	#endif
+
+	#if PERSISTENT_COUNTERS
+		this->UpdateRecord();
+	#endif
 }
 
 void PeriodLog::IncreaseAccess(const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread), const size_t type, const size_t size /*in bytes*/) {
@@ -52,17 +120,50 @@ void PeriodLog::IncreaseAccess(const bool isThreadInjectionEnabled IF_COMMA_PIN_
 		if (isBufferInThread) {
 	#endif
 
-	this->m_accessedBytesCount[isThreadInjectionEnabled][type] += size;
+	this->AccessedBytesCount(isThreadInjectionEnabled, type) += size;
+
+	#if LIVE_STATISTICS
+		LiveStatistics::g_accessedBytes[isThreadInjectionEnabled][type] += size;
+	#endif
 
 	#if PIN_LOCKED
 		}
 	#endif
 }
 
+#if THREAD_PRIVATE_ACCESS_COUNTING
+	//MUST LOCK
+	void PeriodLog::MergeThreadAccessCounts(ThreadAccessCounts& threadCounts) {
+		for (size_t i = 0; i < AccessPrecision::Size; ++i) {
+			for (size_t j = 0; j < AccessTypes::Size; ++j) {
+				this->AccessedBytesCount(i, j) += threadCounts.m_accessedBytesCount[i][j];
+
+				#if LIVE_STATISTICS
+					LiveStatistics::g_accessedBytes[i][j] += threadCounts.m_accessedBytesCount[i][j];
+				#endif
+
+				threadCounts.m_accessedBytesCount[i][j] = 0;
+			}
+		}
+
+		#if LOG_FAULTS
+			for (size_t errorCat = 0; errorCat < ThreadAccessCounts::ACCESS_ERROR_CATEGORIES; ++errorCat) {
+				uint64_t* const errorsByBit = this->GetErrorCountsByBit(errorCat);
+				uint64_t* const threadErrorsByBit = threadCounts.GetErrorCountsByBit(errorCat);
+
+				for (size_t bit = 0; bit < threadCounts.m_bitDepth; ++bit) {
+					errorsByBit[bit] += threadErrorsByBit[bit];
+					threadErrorsByBit[bit] = 0;
+				}
+			}
+		#endif
+	}
+#endif
+
 bool PeriodLog::IsVirgin() const {
 	for (size_t i = 0; i < AccessPrecision::Size; ++i) {
 		for (size_t j = 0; j < AccessTypes::Size; ++j) {
-			if (this->m_accessedBytesCount[i][j] != 0) {
+			if (this->AccessedBytesCount(i, j) != 0) {
 				return false;
 			}
 		}
@@ -71,7 +172,24 @@ bool PeriodLog::IsVirgin() const {
 	return true;
 }
 
-void PeriodLog::WriteBerIndexesToFile(std::ofstream &outputLog, const std::string &basePadding /*= ""*/) const {
+#if LAZY_PERIOD_ADVANCEMENT
+	uint64_t PeriodLog::GetLastPeriod() const {
+		return this->m_period + this->m_periodCount - 1;
+	}
+#endif
+
+void PeriodLog::WritePeriodsToFile(std::ostream &outputLog, const std::string &basePadding /*= ""*/) const {
+	#if LAZY_PERIOD_ADVANCEMENT
+		if (this->m_periodCount > 1) {
+			outputLog << basePadding << "For the periods: " << this->m_period << " to " << this->GetLastPeriod() << " (idle)" << std::endl;
+			return;
+		}
+	#endif
+
+	outputLog << basePadding << "For the period: " << this->m_period << std::endl;
+}
+
+void PeriodLog::WriteBerIndexesToFile(std::ostream &outputLog, const std::string &basePadding /*= ""*/) const {
 	for (size_t i = 0; i < ErrorCategory::Size; ++i) {
 		outputLog << basePadding << ErrorCategoryNames[i] << " sub-BER index: " <<
 		#if MULTIPLE_BER_CONFIGURATION
@@ -85,15 +203,19 @@ void PeriodLog::WriteBerIndexesToFile(std::ofstream &outputLog, const std::strin
 
 #if LOG_FAULTS
 	uint64_t* PeriodLog::GetErrorCountsByBit(const size_t errorCat) const {
-		return this->m_errorsCountsByBit[errorCat].get();
+		#if PERSISTENT_COUNTERS
+			return PersistentCountersLayout::GetErrorCountsByBit(this->m_record, errorCat);
+		#else
+			return this->m_errorsCountsByBit[errorCat].get();
+		#endif
 	}
 
-	void PeriodLog::WriteAndSumIndividualInjectionArray(std::ofstream &outputLog, const std::string errorType, const size_t bitDepth, uint64_t &bufferTotalInjected, uint64_t const *const injectedByBit, const std::string &basePadding /*= ""*/) const {
+	void PeriodLog::WriteAndSumIndividualInjectionArray(std::ostream &outputLog, const std::string errorType, const size_t bitDepth, ErrorCount &bufferTotalInjected, ErrorCount const *const injectedByBit, const std::string &basePadding /*= ""*/) const {
 		const std::string padding = basePadding + '\t';
 
 		outputLog << padding << errorType << " errors injected by bit:" << std::endl;
 
-		uint64_t periodTotalInjected = 0;
+		ErrorCount periodTotalInjected = 0;
 		for (size_t i = 0; i < bitDepth; ++i) {
 			outputLog << padding << "\tBit " << i << ": " << injectedByBit[i] << std::endl;
 			periodTotalInjected += injectedByBit[i];
@@ -106,27 +228,98 @@ void PeriodLog::WriteBerIndexesToFile(std::ofstream &outputLog, const std::strin
 	}
 #endif
 
-void PeriodLog::WriteAccessLogToFile(std::ofstream &outputLog, const size_t bitDepth, const size_t dataSizeInBytes, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> &bufferAccessedBytes, std::array<uint64_t, ErrorCategory::Size> &totalTargetInjections, const std::string &basePadding /*= ""*/) const {
+#if ANALYTIC_ERROR_EXPECTATION
+	//probability of a single exposure (one access, or one period for passive errors) flipping the given bit, mirroring each fault injector
+	static double GetBitErrorProbability(const ErrorType& ber, const size_t bit, const size_t bitDepth) {
+		#if DISTANCE_BASED_FAULT_INJECTOR
+			//the distance between errors is |N(mean, dev)| bits, so the error rate is the inverse of its expected value (approximated)
+			const double mean = ber.first;
+			const double dev = ber.second;
+			const double expectedDistance = (dev == 0) ? std::abs(mean) : (dev * std::sqrt(2.0 / M_PI) * std::exp(-(mean * mean) / (2.0 * dev * dev))) + (mean * std::erf(mean / (dev * std::sqrt(2.0))));
+			return 1.0 / std::max(expectedDistance, 1.0);
+		#elif GRANULAR_FAULT_INJECTOR
+			return std::min(ber * static_cast<double>(bitDepth), 1.0) / static_cast<double>(bitDepth);
+		#elif MULTIPLE_BER_ELEMENT
+			return ber[bit];
+		#else
+			return ber;
+		#endif
+	}
+
+	std::unique_ptr<ErrorCount[]> PeriodLog::CalculateExpectedErrorsByBit(const InjectionConfigurationLocal &injectorCfg, const size_t errorCat, const size_t dataSizeInBytes, const size_t numberOfElements) const {
+		const size_t bitDepth = injectorCfg.GetBitDepth();
+		std::unique_ptr<ErrorCount[]> expectedByBit = std::make_unique<ErrorCount[]>(bitDepth);
+
+		#if MULTIPLE_BER_CONFIGURATION
+			const ErrorType ber = injectorCfg.GetBer(errorCat, this->m_berIndex[errorCat]);
+		#else
+			const ErrorType ber = injectorCfg.GetBer(errorCat);
+		#endif
+
+		if (!InjectionConfigurationBase::ShouldGoOn(ber)) {
+			return expectedByBit;
+		}
+
+		#if ENABLE_PASSIVE_INJECTION && LAZY_PERIOD_ADVANCEMENT
+			const size_t exposedElements = (errorCat == ErrorCategory::Passive) ? (numberOfElements * this->m_periodCount) : (this->AccessedBytesCount(AccessPrecision::Approximate, errorCat) / dataSizeInBytes);
+		#elif ENABLE_PASSIVE_INJECTION
+			const size_t exposedElements = (errorCat == ErrorCategory::Passive) ? numberOfElements : (this->AccessedBytesCount(AccessPrecision::Approximate, errorCat) / dataSizeInBytes);
+		#else
+			const size_t exposedElements = this->AccessedBytesCount(AccessPrecision::Approximate, errorCat) / dataSizeInBytes;
+		#endif
+
+		#if LS_BIT_DROPPING && DEFAULT_FAULT_INJECTOR
+			const size_t countStart = injectorCfg.GetLSBDropped(); //dropped bits are never flipped
+		#else
+			constexpr size_t countStart = 0;
+		#endif
+
+		for (size_t bit = countStart; bit < bitDepth; ++bit) {
+			expectedByBit[bit] = static_cast<double>(exposedElements) * GetBitErrorProbability(ber, bit, bitDepth);
+		}
+
+		return expectedByBit;
+	}
+#endif
+
+void PeriodLog::WriteAccessLogToFile(std::ostream &outputLog, const size_t bitDepth, const size_t dataSizeInBytes, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> &bufferAccessedBytes, std::array<ErrorCount, ErrorCategory::Size> &totalTargetInjections IF_COMMA_PERIOD_SAMPLING(SampledBytes &totalTargetSampledBytes) IF_COMMA_ANALYTIC_ERROR_EXPECTATION(const InjectionConfigurationLocal &injectorCfg) IF_COMMA_ANALYTIC_ERROR_EXPECTATION(const size_t numberOfElements), const std::string &basePadding /*= ""*/) const {
 	const std::string padding = basePadding + '\t';
 
 	outputLog << basePadding << "PERIOD START" << std::endl;
-	outputLog << padding << "For the period: " << this->m_period << std::endl;
+	this->WritePeriodsToFile(outputLog, padding);
+
+	#if PERIOD_SAMPLING
+		outputLog << padding << "Sampled: " << (this->m_isSampled ? "Yes" : "No") << std::endl;
+	#endif
 
 	for (size_t i = 0; i < AccessPrecision::Size; ++i) {
 		for (size_t j = 0; j < AccessTypes::Size; ++j) {
-			WriteAccessedBytesToFile(outputLog, bitDepth, dataSizeInBytes, this->m_accessedBytesCount[i][j], AccessTypesNames[j], "Period " + AccessPrecisionNames[i], padding);
-			bufferAccessedBytes[i][j] += this->m_accessedBytesCount[i][j];
+			WriteAccessedBytesToFile(outputLog, bitDepth, dataSizeInBytes, this->AccessedBytesCount(i, j), AccessTypesNames[j], "Period " + AccessPrecisionNames[i], padding);
+			bufferAccessedBytes[i][j] += this->AccessedBytesCount(i, j);
 		}
 	}
 	outputLog << std::endl;
 
+	#if PERIOD_SAMPLING
+		if (this->m_isSampled) {
+			for (size_t j = 0; j < AccessTypes::Size; ++j) {
+				totalTargetSampledBytes[j] += this->AccessedBytesCount(AccessPrecision::Approximate, j);
+			}
+		}
+	#endif
+
 	this->WriteBerIndexesToFile(outputLog, padding);
 
 	#if LOG_FAULTS
 		outputLog << std::endl;
 		outputLog << padding << "INJECTION COUNT START" << std::endl;
 		for (size_t i = 0; i < ErrorCategory::Size; ++i) {
-			this->WriteAndSumIndividualInjectionArray(outputLog, ErrorCategoryNames[i], bitDepth, totalTargetInjections[i], this->GetErrorCountsByBit(i), padding);
+			#if ANALYTIC_ERROR_EXPECTATION
+				const std::unique_ptr<ErrorCount[]> expectedByBit = this->CalculateExpectedErrorsByBit(injectorCfg, i, dataSizeInBytes, numberOfElements);
+				this->WriteAndSumIndividualInjectionArray(outputLog, ErrorCategoryNames[i], bitDepth, totalTargetInjections[i], expectedByBit.get(), padding);
+			#else
+				this->WriteAndSumIndividualInjectionArray(outputLog, ErrorCategoryNames[i], bitDepth, totalTargetInjections[i], this->GetErrorCountsByBit(i), padding);
+			#endif
 		}
 		outputLog << padding << "INJECTION COUNT END" << std::endl;
 	#endif
@@ -154,22 +347,24 @@ void PeriodLog::CalculateEnergyConsumptionByErrorCategory(std::array<std::array<
 void PeriodLog::CalculatePeriodEnergyConsumption(std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &periodEnergy, const ConsumptionProfile &respectiveConsumptionProfile, const size_t bitDepth, const size_t dataSizeInBytes, const size_t bufferSizeInBytes) const {
 	//precise access
 	/*for (size_t accessType = 0; accessType < AccessTypes::Size; ++accessType) {
-			this->CalculateEnergyConsumptionByErrorCategory(periodEnergy, respectiveConsumptionProfile, bitDepth, dataSizeInBytes, ConsumptionType::Reference, accessType, this->m_accessedBytesCount[AccessPrecision::Precise][accessType]);
+			this->CalculateEnergyConsumptionByErrorCategory(periodEnergy, respectiveConsumptionProfile, bitDepth, dataSizeInBytes, ConsumptionType::Reference, accessType, this->AccessedBytesCount(AccessPrecision::Precise, accessType));
 	}*/
 	
 	//approximate access
 	for (size_t consumptionTypeIndex = 0; consumptionTypeIndex < ConsumptionType::Size; ++consumptionTypeIndex) {
 		for (size_t accessType = 0; accessType < AccessTypes::Size; ++accessType) {
-			this->CalculateEnergyConsumptionByErrorCategory(periodEnergy, respectiveConsumptionProfile, bitDepth, dataSizeInBytes, consumptionTypeIndex, accessType, this->m_accessedBytesCount[consumptionTypeIndex][accessType]);
+			this->CalculateEnergyConsumptionByErrorCategory(periodEnergy, respectiveConsumptionProfile, bitDepth, dataSizeInBytes, consumptionTypeIndex, accessType, this->AccessedBytesCount(consumptionTypeIndex, accessType));
 		}
 
-		#if ENABLE_PASSIVE_INJECTION
+		#if ENABLE_PASSIVE_INJECTION && LAZY_PERIOD_ADVANCEMENT
+			this->CalculateEnergyConsumptionByErrorCategory(periodEnergy, respectiveConsumptionProfile, bitDepth, dataSizeInBytes, consumptionTypeIndex, ErrorCategory::Passive, bufferSizeInBytes * this->m_periodCount); //data is kept through every period
+		#elif ENABLE_PASSIVE_INJECTION
 			this->CalculateEnergyConsumptionByErrorCategory(periodEnergy, respectiveConsumptionProfile, bitDepth, dataSizeInBytes, consumptionTypeIndex, ErrorCategory::Passive, bufferSizeInBytes);
 		#endif
 	}
 }
 
-void PeriodLog::WriteEnergyLogToFile(std::ofstream &outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &bufferEnergy, const ConsumptionProfile &respectiveConsumptionProfile, const size_t bitDepth, const size_t dataSizeInBytes, const size_t bufferSizeInBytes, const std::string &basePadding /*= ""*/) const {
+void PeriodLog::WriteEnergyLogToFile(std::ostream &outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &bufferEnergy, const ConsumptionProfile &respectiveConsumptionProfile, const size_t bitDepth, const size_t dataSizeInBytes, const size_t bufferSizeInBytes, const std::string &basePadding /*= ""*/) const {
 	const std::string padding = basePadding + '\t';
 
 	std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> periodEnergy;
@@ -178,7 +373,7 @@ void PeriodLog::WriteEnergyLogToFile(std::ofstream &outputLog, std::array<std::a
 	this->CalculatePeriodEnergyConsumption(periodEnergy, respectiveConsumptionProfile, bitDepth, dataSizeInBytes, bufferSizeInBytes);
 
 	outputLog << basePadding << "PERIOD START" << std::endl;
-	outputLog << padding << "For the period: " << this->m_period << std::endl;
+	this->WritePeriodsToFile(outputLog, padding);
 
 	WriteEnergyConsumptionToLogFile(outputLog, periodEnergy, respectiveConsumptionProfile.HasReferenceValues(), true, padding);
 
@@ -190,7 +385,7 @@ void PeriodLog::WriteEnergyLogToFile(std::ofstream &outputLog, std::array<std::a
 	outputLog << std::endl;
 }
 
-void WriteEnergyConsumptionToLogFile(std::ofstream &outputLog, const std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN /*= true*/, const std::string &basePadding /*= ""*/) {
+void WriteEnergyConsumptionToLogFile(std::ostream &outputLog, const std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN /*= true*/, const std::string &basePadding /*= ""*/) {
 	const std::string padding = basePadding + '\t';
 	
 	for (size_t consumptionTypeIndex = 0; consumptionTypeIndex < ConsumptionType::Size; ++consumptionTypeIndex) {
@@ -213,7 +408,7 @@ void WriteEnergyConsumptionToLogFile(std::ofstream &outputLog, const std::array<
 	outputLog << std::endl;
 }
 
-//void WriteEnergyConsumptionSavingsToLogFile(std::ofstream &outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN /*= true*/, const std::string &basePadding /*= ""*/) {
+//void WriteEnergyConsumptionSavingsToLogFile(std::ostream &outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN /*= true*/, const std::string &basePadding /*= ""*/) {
 /*	const std::string padding = basePadding + '\t';
 	
 	outputLog << basePadding << "ENERGY CONSUMPTION SAVINGS" << std::endl;
@@ -238,7 +433,30 @@ void AddEnergyConsumption(std::array<std::array<double, ErrorCategory::Size>, Co
 	}
 }
 
-void WriteAccessedBytesToFile(std::ofstream &outputLog, const size_t bitDepth, const size_t dataSizeInBytes, const uint64_t accessedBytes, const std::string &accessedType, const std::string &accessScope, const std::string &padding /*= ""*/) {
+void WriteAccessedBytesToFile(std::ostream &outputLog, const size_t bitDepth, const size_t dataSizeInBytes, const uint64_t accessedBytes, const std::string &accessedType, const std::string &accessScope, const std::string &padding /*= ""*/) {
 	outputLog << padding << accessScope << " " << accessedType << " Software Implementation Bytes/Bits: " << accessedBytes << " / " << (accessedBytes * BYTE_SIZE) << std::endl;
 	outputLog << padding << accessScope << " " << accessedType << " Proposed Implementation Bytes/Bits: " << (((accessedBytes / dataSizeInBytes) * bitDepth) / BYTE_SIZE) << " / " << ((accessedBytes / dataSizeInBytes) * bitDepth) << std::endl;
-}
\ No newline at end of file
+}
+
+#if PERIOD_SAMPLING && LOG_FAULTS
+	//read and write errors scale with the approximate bytes accessed, so the sampled counts are extrapolated by the ratio of all to sampled approximate bytes
+	//the bounds assume the sampled count is Poisson distributed (95% confidence), falling back to the rule of three when nothing was injected
+	void WriteExtrapolatedInjectionsToFile(std::ostream &outputLog, const std::string &errorType, const uint64_t sampledInjections, const uint64_t approximateBytes, const uint64_t sampledApproximateBytes, const std::string &padding /*= ""*/) {
+		outputLog << padding << "Extrapolated " << errorType << " Errors: ";
+
+		if (sampledApproximateBytes == 0) {
+			outputLog << ((approximateBytes == 0) ? "0" : "NaN") << std::endl;
+			return;
+		}
+
+		const double scale = static_cast<double>(approximateBytes) / static_cast<double>(sampledApproximateBytes);
+		const double estimate = static_cast<double>(sampledInjections) * scale;
+
+		if (sampledInjections == 0) {
+			outputLog << "0 (95% upper bound: " << (3.0 * scale) << ")" << std::endl;
+		} else {
+			const double margin = 1.96 * std::sqrt(static_cast<double>(sampledInjections)) * scale;
+			outputLog << estimate << " +- " << margin << " (95% confidence)" << std::endl;
+		}
+	}
+#endif
\ No newline at end of file
@@ -6,49 +6,140 @@
 #include <stdlib.h> 
 #include <fstream>
 #include <array>
+#include <cmath>
 
 #include "compiling-options.h"
 #include "injector-configuration.h"
 #include "configuration-input.h"
+#include "persistent-counters.h"
+
+#if PERIOD_SAMPLING
+	extern bool g_isSampledPeriod;
+
+	typedef std::array<uint64_t, AccessTypes::Size> SampledBytes; //approximate bytes accessed in sampled periods, by access type
+#endif
+
+#if ANALYTIC_ERROR_EXPECTATION
+	typedef double ErrorCount;
+#else
+	typedef uint64_t ErrorCount;
+#endif
+
+#if THREAD_PRIVATE_ACCESS_COUNTING
+	//shadow of the access counts of a PeriodLog for a single thread, aligned so that the counts of different threads never share a cache line
+	//passive errors are injected by the buffer itself, not by an accessing thread, so they are kept in the PeriodLog only
+	class alignas(64) ThreadAccessCounts {
+		public:
+			static constexpr size_t ACCESS_ERROR_CATEGORIES = ErrorCategory::Write + 1; //Read and Write
+
+			std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> m_accessedBytesCount;
+
+			#if LOG_FAULTS
+				const size_t m_bitDepth;
+				const std::unique_ptr<uint64_t[]> m_errorsCountsByBit; //Read and Write, m_bitDepth each
+
+				ThreadAccessCounts(const size_t bitDepth) : m_accessedBytesCount(), m_bitDepth(bitDepth), m_errorsCountsByBit(std::make_unique<uint64_t[]>(ACCESS_ERROR_CATEGORIES * bitDepth)) {}
+
+				uint64_t* GetErrorCountsByBit(const size_t errorCat) const {
+					return this->m_errorsCountsByBit.get() + (errorCat * this->m_bitDepth);
+				}
+			#else
+				ThreadAccessCounts(const size_t /*bitDepth*/) : m_accessedBytesCount() {}
+			#endif
+	};
+#endif
 
 class PeriodLog {
 	public:
 		uint64_t m_period;
 
-		std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> m_accessedBytesCount;
+		#if LAZY_PERIOD_ADVANCEMENT
+			uint64_t m_periodCount; //consecutive periods, from m_period on, covered by the log (more than one only for idle periods stored on catch-up)
+
+			uint64_t GetLastPeriod() const;
+		#endif
+
+		#if PERSISTENT_COUNTERS
+			PersistentCountersLayout::PeriodRecord* m_record; //holds the accessed bytes and errors by bit of the log, in the persistent counters file
+
+			uint64_t& AccessedBytesCount(const size_t precision, const size_t type) {
+				return this->m_record->m_accessedBytes[precision][type];
+			}
+
+			uint64_t AccessedBytesCount(const size_t precision, const size_t type) const {
+				return this->m_record->m_accessedBytes[precision][type];
+			}
+
+			void UpdateRecord() const;
+		#else
+			std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size> m_accessedBytesCount;
+
+			uint64_t& AccessedBytesCount(const size_t precision, const size_t type) {
+				return this->m_accessedBytesCount[precision][type];
+			}
+
+			uint64_t AccessedBytesCount(const size_t precision, const size_t type) const {
+				return this->m_accessedBytesCount[precision][type];
+			}
+		#endif
 
 		#if LOG_FAULTS
-			std::array<std::unique_ptr<uint64_t[]>, ErrorCategory::Size> m_errorsCountsByBit;
+			#if !PERSISTENT_COUNTERS
+				std::array<std::unique_ptr<uint64_t[]>, ErrorCategory::Size> m_errorsCountsByBit;
+			#endif
 
-			void WriteAndSumIndividualInjectionArray(std::ofstream& outputLog, const std::string errorType, const size_t bitDepth, uint64_t& bufferTotalInjected, uint64_t const * const injectedByBit, const std::string& basePadding = "") const;
+			void WriteAndSumIndividualInjectionArray(std::ostream& outputLog, const std::string errorType, const size_t bitDepth, ErrorCount& bufferTotalInjected, ErrorCount const * const injectedByBit, const std::string& basePadding = "") const;
+		#endif
+
+		#if ANALYTIC_ERROR_EXPECTATION
+			std::unique_ptr<ErrorCount[]> CalculateExpectedErrorsByBit(const InjectionConfigurationLocal& injectorCfg, const size_t errorCat, const size_t dataSizeInBytes, const size_t numberOfElements) const;
 		#endif
 
 		#if MULTIPLE_BER_CONFIGURATION
 			std::array<size_t, ErrorCategory::Size> m_berIndex;
 		#endif
 
+		#if PERIOD_SAMPLING
+			bool m_isSampled;
+		#endif
+
 		void IncreaseAccess(const bool isThreadInjectionEnabled IF_COMMA_PIN_LOCKED(const bool isBufferInThread), const size_t type, const size_t size /*in bytes*/);
 
-		void WriteBerIndexesToFile(std::ofstream& outputLog, const std::string& basePadding = "") const;
+		#if THREAD_PRIVATE_ACCESS_COUNTING
+			void MergeThreadAccessCounts(ThreadAccessCounts& threadCounts);
+		#endif
+
+		void WriteBerIndexesToFile(std::ostream& outputLog, const std::string& basePadding = "") const;
 
 		PeriodLog(PeriodLog& other, const size_t bitDepth);
-		PeriodLog(const uint64_t period, const InjectionConfigurationLocal& injectorCfg);
+		PeriodLog(const uint64_t period, const InjectionConfigurationLocal& injectorCfg IF_COMMA_PERSISTENT_COUNTERS(const uint64_t bufferRecord));
+
+		#if PERSISTENT_COUNTERS
+			PeriodLog(const PeriodLog&) = delete;
+			~PeriodLog();
+		#endif
 
 		uint64_t* GetErrorCountsByBit(const size_t errorCat) const;
 
 		bool IsVirgin() const;
 
+		void WritePeriodsToFile(std::ostream& outputLog, const std::string& basePadding = "") const;
+
 		void ResetCounts(const uint64_t period, const InjectionConfigurationLocal& injectorCfg);
 
-		void WriteAccessLogToFile(std::ofstream& outputLog, const size_t bitDepth, const size_t dataSizeInBytes, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size>& bufferAccessedBytes, std::array<uint64_t, ErrorCategory::Size>& totalTargetInjections, const std::string& basePadding = "") const;
-		void WriteEnergyLogToFile(std::ofstream& outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& bufferEnergy, const ConsumptionProfile& respectiveConsumptionProfile, const size_t bitDepth, const size_t dataSizeInBytes, const size_t bufferSizeInBytes, const std::string& basePadding = "") const;
+		void WriteAccessLogToFile(std::ostream& outputLog, const size_t bitDepth, const size_t dataSizeInBytes, std::array<std::array<uint64_t, AccessTypes::Size>, AccessPrecision::Size>& bufferAccessedBytes, std::array<ErrorCount, ErrorCategory::Size>& totalTargetInjections IF_COMMA_PERIOD_SAMPLING(SampledBytes& totalTargetSampledBytes) IF_COMMA_ANALYTIC_ERROR_EXPECTATION(const InjectionConfigurationLocal& injectorCfg) IF_COMMA_ANALYTIC_ERROR_EXPECTATION(const size_t numberOfElements), const std::string& basePadding = "") const;
+		void WriteEnergyLogToFile(std::ostream& outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& bufferEnergy, const ConsumptionProfile& respectiveConsumptionProfile, const size_t bitDepth, const size_t dataSizeInBytes, const size_t bufferSizeInBytes, const std::string& basePadding = "") const;
 		void CalculateEnergyConsumptionByErrorCategory(std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &periodEnergy, const ConsumptionProfile &respectiveConsumptionProfile, const size_t bitDepth, const size_t dataSizeInBytes, const size_t consumptionTypeIndex, const size_t errorCat, const size_t softwareProcessedBytes) const;
 		void CalculatePeriodEnergyConsumption(std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &periodEnergy, const ConsumptionProfile &respectiveConsumptionProfile, const size_t bitDepth, const size_t dataSizeInBytes, const size_t bufferSizeInBytes) const;
 };
 
-void WriteEnergyConsumptionToLogFile(std::ofstream &outputLog, const std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN = true, const std::string &basePadding = "");
-//void WriteEnergyConsumptionSavingsToLogFile(std::ofstream &outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN = true, const std::string &basePadding = "");
+void WriteEnergyConsumptionToLogFile(std::ostream &outputLog, const std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN = true, const std::string &basePadding = "");
+//void WriteEnergyConsumptionSavingsToLogFile(std::ostream &outputLog, std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size> &energy, const bool hasReferenceValues, const bool checkNaN = true, const std::string &basePadding = "");
 void AddEnergyConsumption(std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& destination, const std::array<std::array<double, ErrorCategory::Size>, ConsumptionType::Size>& source);
-void WriteAccessedBytesToFile(std::ofstream& outputLog, const size_t bitDepth, const size_t dataSizeInBytes, const uint64_t accessedBytes, const std::string& accessedType, const std::string& accessScope, const std::string& padding = "");
+void WriteAccessedBytesToFile(std::ostream& outputLog, const size_t bitDepth, const size_t dataSizeInBytes, const uint64_t accessedBytes, const std::string& accessedType, const std::string& accessScope, const std::string& padding = "");
+
+#if PERIOD_SAMPLING && LOG_FAULTS
+	void WriteExtrapolatedInjectionsToFile(std::ostream& outputLog, const std::string& errorType, const uint64_t sampledInjections, const uint64_t approximateBytes, const uint64_t sampledApproximateBytes, const std::string& padding = "");
+#endif
 
 #endif /* BUFFER_LOG_PERIOD_H */
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef PERSISTENT_COUNTERS_LAYOUT_H
+#define PERSISTENT_COUNTERS_LAYOUT_H
+
+//layout of the persistent counters file, shared between the pintool and the reader (persistent_counters_reader/)
+//the file is a Header followed by variable-size records (one BufferRecord per buffer, one PeriodRecord per period log), appended in allocation order
+//it must not depend on Pin nor on the compiling options
+
+#include <cstdint>
+#include <cstddef>
+
+namespace PersistentCountersLayout {
+	constexpr uint64_t MAGIC	= 0x314E43504C585041; //"APXLPCN1"
+	constexpr uint32_t VERSION	= 1;
+
+	constexpr size_t ACCESS_PRECISIONS	= 2; //Precise, Approximate
+	constexpr size_t ACCESS_TYPES		= 2; //Read, Write
+	constexpr size_t ERROR_CATEGORIES	= 3; //Read, Write, Passive
+
+	//compiling options of the pintool that change the report
+	constexpr uint32_t FLAG_LOG_FAULTS			= 1 << 0; //period records are followed by their errors by bit
+	constexpr uint32_t FLAG_PERIOD_COUNT		= 1 << 1; //LAZY_PERIOD_ADVANCEMENT, idle period records may span several periods
+	constexpr uint32_t FLAG_PERIOD_SAMPLING		= 1 << 2;
+	constexpr uint32_t FLAG_EXPECTED_ERRORS		= 1 << 3; //ANALYTIC_ERROR_EXPECTATION, the text report holds expected errors, the file only the injected ones
+	constexpr uint32_t FLAG_PASSIVE_INJECTION	= 1 << 4; //the Passive category is reported (its counters are there, zeroed, either way)
+
+	constexpr uint32_t BUFFER_RECORD	= 1;
+	constexpr uint32_t PERIOD_RECORD	= 2;
+
+	struct Header {
+		uint64_t m_magic;
+		uint32_t m_version;
+		uint32_t m_flags;
+		uint64_t m_capacity;		//size of the file, in bytes
+		uint64_t m_usedBytes;		//header included, moved past a record only once it is initialized
+		uint64_t m_droppedRecords;	//records past the capacity, kept only in memory
+		uint64_t m_injectionCalls;	//as of the last record allocation (or of the end of the execution)
+		uint32_t m_processId;
+		uint32_t m_isComplete;		//set once the pintool reached Fini, so the text logs were written too
+		uint64_t m_reserved;
+	};
+
+	struct RecordHeader {
+		uint32_t m_type;
+		uint32_t m_size;			//in bytes, this header included (multiple of 8)
+	};
+
+	struct BufferRecord {
+		RecordHeader m_header;
+		int64_t m_bufferId;
+		int64_t m_configurationId;
+		uint64_t m_initialAddress;
+		uint64_t m_finalAddress;
+		uint64_t m_dataSizeInBytes;
+		uint64_t m_bitDepth;
+	};
+
+	struct PeriodRecord {
+		RecordHeader m_header;
+		uint64_t m_bufferRecord;	//file offset of the BufferRecord of its buffer (0 if it did not fit)
+		uint64_t m_period;
+		uint64_t m_periodCount;
+		uint64_t m_berIndex[ERROR_CATEGORIES];
+		uint32_t m_bitDepth;
+		uint8_t m_isSampled;
+		uint8_t m_isDiscarded;		//dropped by the pintool, e.g. when a buffer is reactivated in the period of one of its stored logs
+		uint16_t m_reserved;
+		uint64_t m_accessedBytes[ACCESS_PRECISIONS][ACCESS_TYPES];
+		//followed (with FLAG_LOG_FAULTS) by ERROR_CATEGORIES arrays of m_bitDepth errors by bit
+	};
+
+	static_assert(sizeof(Header) == 64, "persistent counters header must keep its size");
+	static_assert(sizeof(BufferRecord) == 56, "persistent buffer record must keep its size");
+	static_assert(sizeof(PeriodRecord) == 96, "persistent period record must keep its size");
+
+	inline size_t GetPeriodRecordSize(const size_t bitDepth, const bool logFaults) {
+		return sizeof(PeriodRecord) + (logFaults ? (ERROR_CATEGORIES * bitDepth * sizeof(uint64_t)) : 0);
+	}
+
+	inline uint64_t* GetErrorCountsByBit(PeriodRecord * const record, const size_t errorCat) {
+		return reinterpret_cast<uint64_t*>(record + 1) + (errorCat * record->m_bitDepth);
+	}
+
+	inline uint64_t const * GetErrorCountsByBit(PeriodRecord const * const record, const size_t errorCat) {
+		return reinterpret_cast<uint64_t const *>(record + 1) + (errorCat * record->m_bitDepth);
+	}
+}
+
+#endif /* PERSISTENT_COUNTERS_LAYOUT_H */
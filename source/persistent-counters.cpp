@@ -0,0 +1,159 @@
+#include "persistent-counters.h"
+
+#if PERSISTENT_COUNTERS
+	#include <iostream>
+	#include <atomic>
+	#include <cstring>
+	#include <cstdlib>
+	#include <new>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+
+	extern uint64_t g_injectionCalls;
+
+	namespace PersistentCounters {
+		static uint8_t* s_mapping = nullptr;
+		static PersistentCountersLayout::Header* s_header = nullptr;
+		static uint64_t s_nextOffset = 0;
+		static bool s_isFinished = false;
+
+		void Initialize(const std::string& filename, const uint64_t capacityInMegabytes) {
+			const uint64_t capacity = capacityInMegabytes << 20;
+
+			if (capacity < sizeof(PersistentCountersLayout::Header)) {
+				std::cerr << "ApproxSS Error: the persistent counters capacity must be greater than 0." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			const int fd = open(filename.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+			if (fd < 0) {
+				std::cerr << "ApproxSS Error: Unable to create persistent counters file: \"" << filename << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			//sparse, only the pages that ever hold records take disk space
+			if (ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+				close(fd);
+				std::cerr << "ApproxSS Error: Unable to size persistent counters file: \"" << filename << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			void* const mapping = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			close(fd);
+
+			if (mapping == MAP_FAILED) {
+				std::cerr << "ApproxSS Error: Unable to map persistent counters file: \"" << filename << "\"." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			s_mapping = static_cast<uint8_t*>(mapping);
+			s_header = new (mapping) PersistentCountersLayout::Header();
+			s_nextOffset = sizeof(PersistentCountersLayout::Header);
+
+			s_header->m_version = PersistentCountersLayout::VERSION;
+			s_header->m_flags = (LOG_FAULTS ? PersistentCountersLayout::FLAG_LOG_FAULTS : 0) | (LAZY_PERIOD_ADVANCEMENT ? PersistentCountersLayout::FLAG_PERIOD_COUNT : 0) | 
+								(PERIOD_SAMPLING ? PersistentCountersLayout::FLAG_PERIOD_SAMPLING : 0) | (ANALYTIC_ERROR_EXPECTATION ? PersistentCountersLayout::FLAG_EXPECTED_ERRORS : 0) | (ENABLE_PASSIVE_INJECTION ? PersistentCountersLayout::FLAG_PASSIVE_INJECTION : 0);
+			s_header->m_capacity = capacity;
+			s_header->m_usedBytes = s_nextOffset;
+			s_header->m_processId = static_cast<uint32_t>(getpid());
+
+			//the magic goes last, so a reader never accepts a half-initialized header
+			std::atomic_thread_fence(std::memory_order_release);
+			s_header->m_magic = PersistentCountersLayout::MAGIC;
+		}
+
+		//MUST LOCK
+		//records are zeroed (fresh file pages), the caller publishes them with Publish() once filled
+		static void* Allocate(const size_t size) {
+			if (s_isFinished || s_nextOffset + size > s_header->m_capacity) {
+				if (s_header->m_droppedRecords++ == 0) {
+					std::cout << "ApproxSS Warning: The persistent counters file is full, later records are only kept in memory." << std::endl;
+				}
+				return nullptr;
+			}
+
+			void* const record = s_mapping + s_nextOffset;
+			s_nextOffset += size;
+			return record;
+		}
+
+		static void Publish() {
+			s_header->m_injectionCalls = g_injectionCalls;
+
+			std::atomic_thread_fence(std::memory_order_release);
+			s_header->m_usedBytes = s_nextOffset;
+		}
+
+		static bool IsInFile(void const * const record) {
+			return record >= s_mapping && record < (s_mapping + s_header->m_capacity);
+		}
+
+		//MUST LOCK
+		uint64_t AddBuffer(const int64_t bufferId, const int64_t configurationId, uint8_t const * const initialAddress, uint8_t const * const finalAddress, const size_t dataSizeInBytes, const size_t bitDepth) {
+			PersistentCountersLayout::BufferRecord* const record = static_cast<PersistentCountersLayout::BufferRecord*>(PersistentCounters::Allocate(sizeof(PersistentCountersLayout::BufferRecord)));
+			if (record == nullptr) {
+				return NO_RECORD;
+			}
+
+			record->m_header.m_type = PersistentCountersLayout::BUFFER_RECORD;
+			record->m_header.m_size = sizeof(PersistentCountersLayout::BufferRecord);
+			record->m_bufferId = bufferId;
+			record->m_configurationId = configurationId;
+			record->m_initialAddress = reinterpret_cast<uintptr_t>(initialAddress);
+			record->m_finalAddress = reinterpret_cast<uintptr_t>(finalAddress);
+			record->m_dataSizeInBytes = dataSizeInBytes;
+			record->m_bitDepth = bitDepth;
+
+			PersistentCounters::Publish();
+
+			return static_cast<uint64_t>(reinterpret_cast<uint8_t*>(record) - s_mapping);
+		}
+
+		//MUST LOCK
+		PersistentCountersLayout::PeriodRecord* AddPeriod(const uint64_t bufferRecord, const size_t bitDepth) {
+			const size_t size = PersistentCountersLayout::GetPeriodRecordSize(bitDepth, LOG_FAULTS);
+
+			PersistentCountersLayout::PeriodRecord* record = static_cast<PersistentCountersLayout::PeriodRecord*>(PersistentCounters::Allocate(size));
+			if (record == nullptr) {
+				record = static_cast<PersistentCountersLayout::PeriodRecord*>(std::calloc(1, size));
+			}
+
+			record->m_header.m_type = PersistentCountersLayout::PERIOD_RECORD;
+			record->m_header.m_size = static_cast<uint32_t>(size);
+			record->m_bufferRecord = bufferRecord;
+			record->m_bitDepth = static_cast<uint32_t>(bitDepth);
+
+			if (PersistentCounters::IsInFile(record)) {
+				PersistentCounters::Publish();
+			}
+
+			return record;
+		}
+
+		//MUST LOCK
+		//records in the file are never reused, just flagged so that the reader skips them
+		void ReleasePeriod(PersistentCountersLayout::PeriodRecord * const record) {
+			if (!PersistentCounters::IsInFile(record)) {
+				std::free(record);
+			} else if (!s_isFinished) {
+				record->m_isDiscarded = 1;
+			}
+		}
+
+		//the logs destroyed after this point (the whole data structure, at the end of Fini) stay in the file as they were
+		//NOTE: the mapping is left for the process exit to release, as those logs still point into it
+		void Finish() {
+			s_isFinished = true;
+
+			s_header->m_injectionCalls = g_injectionCalls;
+			s_header->m_isComplete = 1;
+
+			msync(s_mapping, s_nextOffset, MS_SYNC);
+
+			if (s_header->m_droppedRecords != 0) {
+				std::cout << "ApproxSS Warning: " << s_header->m_droppedRecords << " records did not fit in the persistent counters file." << std::endl;
+			}
+		}
+	}
+#endif
@@ -0,0 +1,38 @@
+#ifndef PERSISTENT_COUNTERS_H
+#define PERSISTENT_COUNTERS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "pin.H"
+
+#include "compiling-options.h"
+
+#if PERSISTENT_COUNTERS
+	#include "persistent-counters-layout.h"
+
+	//the counters of every period log live in a file-backed shared mapping instead of the heap, so a crashing target still leaves them on disk
+	//updating a counter is a plain store to the mapping (no I/O), the kernel writes the dirty pages back even if the process is killed
+	namespace PersistentCounters {
+		constexpr uint64_t NO_RECORD = 0; //the header is at offset 0, so no record ever is
+
+		static_assert(PersistentCountersLayout::ACCESS_PRECISIONS == AccessPrecision::Size, "persistent counters layout out of sync with AccessPrecision");
+		static_assert(PersistentCountersLayout::ACCESS_TYPES == AccessTypes::Size, "persistent counters layout out of sync with AccessTypes");
+		static_assert(PersistentCountersLayout::ERROR_CATEGORIES >= ErrorCategory::Size, "persistent counters layout out of sync with ErrorCategory");
+
+		void Initialize(const std::string& filename, const uint64_t capacityInMegabytes);
+
+		//MUST LOCK
+		uint64_t AddBuffer(const int64_t bufferId, const int64_t configurationId, uint8_t const * const initialAddress, uint8_t const * const finalAddress, const size_t dataSizeInBytes, const size_t bitDepth);
+		//MUST LOCK
+		//zeroed, on the heap once the file is full
+		PersistentCountersLayout::PeriodRecord* AddPeriod(const uint64_t bufferRecord, const size_t bitDepth);
+		//MUST LOCK
+		void ReleasePeriod(PersistentCountersLayout::PeriodRecord * const record);
+
+		//NOTE: should only be called after the target application threads are done (and after the buffers retired)
+		void Finish();
+	}
+#endif
+
+#endif /* PERSISTENT_COUNTERS_H */
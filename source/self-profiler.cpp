@@ -0,0 +1,86 @@
+#include "self-profiler.h"
+
+#if SELF_PROFILING
+	namespace SelfProfiler {
+		PerThreadSlots<ThreadCounters> g_threadCounters{};
+
+		bool ThreadCounters::IsVirgin() const {
+			for (size_t i = 0; i < ProfiledSection::Size; ++i) {
+				if (this->m_calls[i] != 0) {
+					return false;
+				}
+			}
+
+			for (size_t i = 0; i < ACCESS_SIZE_BUCKETS; ++i) {
+				if (this->m_accessSizes[i] != 0) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		void ThreadCounters::Add(const ThreadCounters& other) {
+			for (size_t i = 0; i < ProfiledSection::Size; ++i) {
+				this->m_calls[i] += other.m_calls[i];
+				this->m_cycles[i] += other.m_cycles[i];
+			}
+
+			for (size_t i = 0; i < ACCESS_SIZE_BUCKETS; ++i) {
+				this->m_accessSizes[i] += other.m_accessSizes[i];
+			}
+
+			for (size_t i = 0; i < SIMD_ELEMENT_BUCKETS; ++i) {
+				this->m_simdElements[i] += other.m_simdElements[i];
+			}
+		}
+
+		void RecordAccessSize(const uint32_t accessSizeInBytes) {
+			size_t bucket = 0;
+			for (uint32_t size = accessSizeInBytes; size > 1 && bucket < (ACCESS_SIZE_BUCKETS - 1); size >>= 1) {
+				++bucket;
+			}
+
+			++SelfProfiler::GetThreadCounters().m_accessSizes[bucket];
+		}
+
+		void RecordSIMDElements(const size_t elementCount) {
+			++SelfProfiler::GetThreadCounters().m_simdElements[std::min(elementCount, SIMD_ELEMENT_BUCKETS - 1)];
+		}
+
+		static void WriteThreadCountersToFile(std::ofstream& outputLog, const std::string& thread, const ThreadCounters& counters) {
+			for (size_t i = 0; i < ProfiledSection::Size; ++i) {
+				outputLog << "section," << thread << ',' << ProfiledSectionNames[i] << ',' << counters.m_calls[i] << ',' << counters.m_cycles[i] << std::endl;
+			}
+
+			for (size_t i = 0; i < ACCESS_SIZE_BUCKETS; ++i) {
+				outputLog << "access_size," << thread << ',' << (1u << i) << ((i == ACCESS_SIZE_BUCKETS - 1) ? "+" : "") << ',' << counters.m_accessSizes[i] << ",0" << std::endl;
+			}
+
+			for (size_t i = 0; i < SIMD_ELEMENT_BUCKETS; ++i) {
+				if (counters.m_simdElements[i] != 0) {
+					outputLog << "simd_elements," << thread << ',' << i << ((i == SIMD_ELEMENT_BUCKETS - 1) ? "+" : "") << ',' << counters.m_simdElements[i] << ",0" << std::endl;
+				}
+			}
+		}
+
+		//NOTE: should only be called after the target application threads are done, the counters are read without synchronization
+		void WriteReportToFile(std::ofstream& outputLog) {
+			outputLog << "record,thread,key,count,cycles" << std::endl;
+
+			ThreadCounters total{};
+
+			for (size_t t = 0; t < PerThreadSlots<ThreadCounters>::MAX_THREADS; ++t) {
+				const ThreadCounters& counters = g_threadCounters[t];
+				if (counters.IsVirgin()) {
+					continue;
+				}
+
+				SelfProfiler::WriteThreadCountersToFile(outputLog, std::to_string(t), counters);
+				total.Add(counters);
+			}
+
+			SelfProfiler::WriteThreadCountersToFile(outputLog, "all", total);
+		}
+	}
+#endif
@@ -0,0 +1,89 @@
+#ifndef SELF_PROFILER_H
+#define SELF_PROFILER_H
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include "pin.H"
+
+#include "compiling-options.h"
+#include "per-thread-slots.h"
+
+#if SELF_PROFILING
+	#include <x86intrin.h>
+
+	struct ProfiledSection {
+		static constexpr size_t CheckAndForward		= 0;
+		static constexpr size_t BufferLookup		= 1;
+		static constexpr size_t InjectFault			= 2;
+		static constexpr size_t BackupReadData		= 3;
+		static constexpr size_t ReverseFaultyRead	= 4;
+		static constexpr size_t ApplyFaultyWrite	= 5;
+		static constexpr size_t PassiveCatchUp		= 6;
+		static constexpr size_t NextPeriod			= 7;
+		static constexpr size_t Size				= 8;
+	};
+
+	const std::array<const std::string, ProfiledSection::Size> ProfiledSectionNames = {"CheckAndForward", "BufferLookup", "InjectFault", "BackupReadData", "ReverseFaultyRead", "ApplyFaultyWrite", "PassiveCatchUp", "NextPeriod"};
+
+	namespace SelfProfiler {
+		constexpr size_t ACCESS_SIZE_BUCKETS	= 8;	//[2^i, 2^(i+1)) bytes, the last bucket also holds anything larger
+		constexpr size_t SIMD_ELEMENT_BUCKETS	= 65;	//exact element count, the last bucket also holds anything larger
+
+		//aligned so that threads never share a cache line
+		class alignas(64) ThreadCounters {
+			public:
+				std::array<uint64_t, ProfiledSection::Size> m_calls;
+				std::array<uint64_t, ProfiledSection::Size> m_cycles;
+				std::array<uint64_t, ACCESS_SIZE_BUCKETS> m_accessSizes;
+				std::array<uint64_t, SIMD_ELEMENT_BUCKETS> m_simdElements;
+
+				bool IsVirgin() const;
+				void Add(const ThreadCounters& other);
+		};
+
+		extern PerThreadSlots<ThreadCounters> g_threadCounters;
+
+		inline ThreadCounters& GetThreadCounters() {
+			return g_threadCounters.Get();
+		}
+
+		inline void RecordSection(const size_t section, const uint64_t startCycle) {
+			ThreadCounters& counters = SelfProfiler::GetThreadCounters();
+			++counters.m_calls[section];
+			counters.m_cycles[section] += __rdtsc() - startCycle;
+		}
+
+		class ScopedTimer {
+			private:
+				const size_t m_section;
+				const uint64_t m_startCycle;
+
+			public:
+				ScopedTimer(const size_t section) : m_section(section), m_startCycle(__rdtsc()) {}
+				~ScopedTimer() { SelfProfiler::RecordSection(this->m_section, this->m_startCycle); }
+		};
+
+		void RecordAccessSize(const uint32_t accessSizeInBytes);
+		void RecordSIMDElements(const size_t elementCount);
+
+		void WriteReportToFile(std::ofstream& outputLog);
+	}
+
+	//inclusive timers: nested sections (e.g. InjectFault inside ApplyFaultyWrite) are also counted by the outer one
+	#define PROFILE_SCOPE(section) SelfProfiler::ScopedTimer profilerScopedTimer(ProfiledSection::section);
+	#define PROFILE_SECTION_START(section) const uint64_t profilerStart##section = __rdtsc();
+	#define PROFILE_SECTION_END(section) SelfProfiler::RecordSection(ProfiledSection::section, profilerStart##section);
+	#define PROFILE_ACCESS_SIZE(size) SelfProfiler::RecordAccessSize(size);
+	#define PROFILE_SIMD_ELEMENTS(count) SelfProfiler::RecordSIMDElements(count);
+#else
+	#define PROFILE_SCOPE(section)
+	#define PROFILE_SECTION_START(section)
+	#define PROFILE_SECTION_END(section)
+	#define PROFILE_ACCESS_SIZE(size)
+	#define PROFILE_SIMD_ELEMENTS(count)
+#endif
+
+#endif /* SELF_PROFILER_H */
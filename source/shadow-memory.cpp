@@ -0,0 +1,30 @@
+#include "shadow-memory.h"
+
+#if SHADOW_MEMORY_LOOKUP
+	#include <iostream>
+	#include <algorithm>
+	#include <sys/mman.h>
+
+	namespace ShadowMemory {
+		Slot* g_pageSlots = nullptr;
+
+		//MAP_NORESERVE: untouched shadow pages read as zero (NO_BUFFER) without ever being committed
+		void Initialize() {
+			void* const mapping = mmap(nullptr, PAGE_COUNT * sizeof(Slot), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+			if (mapping == MAP_FAILED) {
+				std::cerr << "ApproxSS Error: Unable to reserve " << ((PAGE_COUNT * sizeof(Slot)) >> 30) << " GiB of address space for the shadow memory (check ulimit -v and vm.overcommit_memory)." << std::endl;
+				PIN_ExitProcess(EXIT_FAILURE);
+			}
+
+			g_pageSlots = static_cast<Slot*>(mapping);
+		}
+
+		//MUST LOCK
+		void SetPages(const size_t firstPage, const size_t endPage, const Slot slot) {
+			if (firstPage < endPage) {
+				std::fill(g_pageSlots + firstPage, g_pageSlots + endPage, slot);
+			}
+		}
+	}
+#endif
@@ -0,0 +1,42 @@
+#ifndef SHADOW_MEMORY_H
+#define SHADOW_MEMORY_H
+
+#include <cstdint>
+#include <cstddef>
+#include "pin.H"
+
+#include "compiling-options.h"
+
+#if SHADOW_MEMORY_LOOKUP
+	//direct-mapped shadow of the application address space, as in sanitizer shadow maps: one buffer slot per page, found with a shift and a load
+	//the shadow of the whole 48-bit address space is reserved up front, but only the shadow pages of pages that ever held an approximate buffer are committed
+	namespace ShadowMemory {
+		typedef uint16_t Slot;
+
+		constexpr size_t PAGE_SHIFT		= 12;
+		constexpr size_t ADDRESS_BITS	= 48;
+		constexpr size_t PAGE_COUNT		= static_cast<size_t>(1) << (ADDRESS_BITS - PAGE_SHIFT);
+
+		constexpr Slot NO_BUFFER		= 0;			//no active buffer touches the page
+		constexpr Slot SHARED_PAGE		= UINT16_MAX;	//more than one active buffer (or one without a slot) touches the page, left to the regular lookup
+		constexpr Slot FIRST_SLOT		= 1;
+		constexpr size_t SLOT_COUNT		= SHARED_PAGE;	//slots are [FIRST_SLOT, SHARED_PAGE)
+
+		extern Slot* g_pageSlots;
+
+		void Initialize();
+		void SetPages(const size_t firstPage, const size_t endPage, const Slot slot); //[firstPage, endPage)
+
+		inline size_t GetPage(uint8_t const * const address) {
+			return reinterpret_cast<uintptr_t>(address) >> PAGE_SHIFT;
+		}
+
+		//addresses beyond the shadowed space are reported as shared pages, so they still go through the regular lookup
+		inline Slot GetSlot(uint8_t const * const address) {
+			const size_t page = ShadowMemory::GetPage(address);
+			return (page < PAGE_COUNT) ? g_pageSlots[page] : SHARED_PAGE;
+		}
+	}
+#endif
+
+#endif /* SHADOW_MEMORY_H */